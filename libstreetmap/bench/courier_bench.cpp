@@ -0,0 +1,594 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Courier benchmark (make bench). Runs travelingCourier on random
+ * instances of every combination of the given sizes, depot counts and turn
+ * penalties, the same instances for the same seed, and writes one row per run
+ * with the route cost, the time spent building the cost matrix, the annealing
+ * moves (or ruin and recreate iterations) per second, how far the solver's own
+ * price of the route is from the verifier's, and the peak memory use, as CSV or JSON.
+ * With --vehicles, every instance runs with travelingCourierFleet instead, once for
+ * each number of trucks (taking at most --max-deliveries each). Such a row is legal
+ * only if every truck's route is legal for the deliveries it serves and every delivery
+ * is served once, and its cost is the sum over the trucks. travelingCourier rows
+ * have 0 vehicles.
+ * With --routes, times that many random findPathBetweenIntersections queries per
+ * turn penalty and seed instead, and a courier matrix over MATRIX_INTERSECTIONS
+ * random intersections, each against the hand-written search the kernel replaced
+ * (tests/hand_written_search.h), the same queries for the same seed. The kernel
+ * builds the matrix on every thread, the hand-written Dijkstra on one.
+ *
+ *   courier_bench <map> [--sizes 20,100,200] [--depots 3] [--turn-penalties 15]
+ *                 [--seeds 3] [--budget 50] [--search annealing|lns]
+ *                 [--vehicles 1,4,8] [--max-deliveries 0]
+ *                 [--routes 0] [--format csv|json] [--out file]
+ *
+ * Peak memory is the whole process's so far (getrusage), so a row can only be
+ * compared with the same row of another run of the same command.
+ * Anything the map loader or solver prints goes to stderr, stdout only has the results.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <omp.h>
+#include <sys/resource.h>
+
+#include "StreetsDatabaseAPI.h"
+#include "m1.h"
+#include "m3.h"
+#include "m4.h"
+#include "m3_helper/travel_profiles.h"
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/courier_fleet.h"
+#include "../tests/courier_verify.h"
+#include "../tests/hand_written_search.h"
+
+namespace {
+
+constexpr int SUCCESS_EXIT_CODE = 0;
+constexpr int ERROR_EXIT_CODE = 1;
+constexpr int BAD_ARGUMENTS_EXIT_CODE = 2;
+
+// Intersections of the courier matrix timed with --routes
+constexpr int MATRIX_INTERSECTIONS = 40;
+
+// What to run
+struct BenchSettings {
+    std::string map_path;
+    std::vector<int> sizes = {20, 100, 200};
+    std::vector<int> depot_counts = {3};
+    std::vector<double> turn_penalties = {15};
+    int num_seeds = 3;
+    double time_budget = TIME_LIMIT;
+    TourSearch tour_search = CourierOptions().tour_search;
+
+    // Truck counts run with travelingCourierFleet, none to run only travelingCourier, and the
+    // most deliveries one truck can take (0 for no limit)
+    std::vector<int> vehicle_counts;
+    int max_deliveries = 0;
+
+    // Route queries timed per turn penalty and seed, 0 to run the courier instead
+    int num_routes = 0;
+    std::string format = "csv";
+    std::string out_path;
+};
+
+// One travelingCourier run
+struct BenchResult {
+    int num_deliveries;
+    int num_depots;
+    int num_vehicles;
+    double turn_penalty;
+    int seed;
+    int threads;
+    std::string search;
+    bool legal;
+    double cost;
+    double precompute_time;
+    double total_time;
+    double moves_per_second;
+    double model_error;
+    long peak_rss_kb;
+};
+
+// One batch of route queries and one courier matrix, timed with the kernel and hand-written
+struct RouteResult {
+    double turn_penalty;
+    int seed;
+    int num_routes;
+    double kernel_time;
+    double hand_written_time;
+
+    // Routes whose travel time differs between the two, which should never happen
+    int mismatches;
+
+    double matrix_kernel_time;
+    double matrix_hand_written_time;
+};
+
+// Parses a comma separated list of numbers
+template <class Number>
+bool parseList(const std::string& text, std::vector<Number>& values) {
+    values.clear();
+    std::stringstream items(text);
+    std::string item;
+
+    while (std::getline(items, item, ',')) {
+        std::stringstream number(item);
+        Number value;
+        if (!(number >> value)) {
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+// Whether every count in the list is at least one
+bool allPositive(const std::vector<int>& counts) {
+    return std::all_of(counts.begin(), counts.end(), [](int count) { return count > 0; });
+}
+
+bool parseSettings(int argc, char** argv, BenchSettings& settings) {
+    if (argc < 2) {
+        return false;
+    }
+    settings.map_path = argv[1];
+
+    for (int arg = 2; arg + 1 < argc; arg += 2) {
+        std::string flag = argv[arg];
+        std::string value = argv[arg + 1];
+        bool parsed = true;
+
+        if (flag == "--sizes") {
+            parsed = parseList(value, settings.sizes) && allPositive(settings.sizes);
+        }
+        else if (flag == "--depots") {
+            parsed = parseList(value, settings.depot_counts) && allPositive(settings.depot_counts);
+        }
+        else if (flag == "--turn-penalties") {
+            parsed = parseList(value, settings.turn_penalties);
+        }
+        else if (flag == "--vehicles") {
+            parsed = parseList(value, settings.vehicle_counts) && allPositive(settings.vehicle_counts);
+        }
+        else if (flag == "--seeds" || flag == "--budget" || flag == "--routes" || flag == "--max-deliveries") {
+            try {
+                if (flag == "--seeds") {
+                    settings.num_seeds = std::stoi(value);
+                    parsed = settings.num_seeds > 0;
+                }
+                else if (flag == "--routes") {
+                    settings.num_routes = std::stoi(value);
+                    parsed = settings.num_routes >= 0;
+                }
+                else if (flag == "--max-deliveries") {
+                    settings.max_deliveries = std::stoi(value);
+                    parsed = settings.max_deliveries >= 0;
+                }
+                else {
+                    settings.time_budget = std::stod(value);
+                    parsed = settings.time_budget > 0;
+                }
+            }
+            catch (const std::logic_error&) {
+                parsed = false;
+            }
+        }
+        else if (flag == "--search" && (value == "annealing" || value == "lns")) {
+            settings.tour_search = (value == "lns") ? TourSearch::LARGE_NEIGHBOURHOOD : TourSearch::ANNEALING;
+        }
+        else if (flag == "--format" && (value == "csv" || value == "json")) {
+            settings.format = value;
+        }
+        else if (flag == "--out") {
+            settings.out_path = value;
+        }
+        else {
+            parsed = false;
+        }
+
+        if (!parsed) {
+            std::cerr << "Bad argument: " << flag << " " << value << "\n";
+            return false;
+        }
+    }
+
+    // Flags come in pairs
+    return argc % 2 == 0;
+}
+
+// Strongly connected component with the most intersections, where every instance is drawn so
+// that it always has a route, and how many intersections it has
+int largestComponent(int& num_intersections) {
+    std::unordered_map<int, int> component_size;
+    int largest = get_intersection_component(0);
+
+    for (IntersectionIdx intersection = 0; intersection < getNumIntersections(); intersection++) {
+        int component = get_intersection_component(intersection);
+        if (++component_size[component] > component_size[largest]) {
+            largest = component;
+        }
+    }
+    num_intersections = component_size[largest];
+    return largest;
+}
+
+// num_deliveries deliveries and num_depots depots on distinct random intersections of the component
+// (a depot is never a pick up or drop off), the same ones for the same seed
+void randomInstance(int num_deliveries, int num_depots, int seed, int component,
+                    std::vector<DeliveryInf>& deliveries, std::vector<IntersectionIdx>& depots) {
+
+    std::mt19937 rng(seed * 7919 + num_deliveries * 31 + num_depots);
+    std::uniform_int_distribution<IntersectionIdx> random_intersection(0, getNumIntersections() - 1);
+    std::unordered_set<IntersectionIdx> used;
+
+    auto unusedIntersection = [&]() {
+        IntersectionIdx intersection = random_intersection(rng);
+        while (get_intersection_component(intersection) != component || !used.insert(intersection).second) {
+            intersection = random_intersection(rng);
+        }
+        return intersection;
+    };
+
+    deliveries.clear();
+    depots.clear();
+    for (int delivery = 0; delivery < num_deliveries; delivery++) {
+        IntersectionIdx pick_up = unusedIntersection();
+        deliveries.push_back(DeliveryInf(pick_up, unusedIntersection()));
+    }
+    for (int depot = 0; depot < num_depots; depot++) {
+        depots.push_back(unusedIntersection());
+    }
+}
+
+double secondsSince(std::chrono::time_point<std::chrono::high_resolution_clock> start_time) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+}
+
+// num_routes random trips between intersections of the component, timed one after another, and a
+// courier matrix between MATRIX_INTERSECTIONS of them, with the kernel and then hand-written
+RouteResult runRoutes(const BenchSettings& settings, int component, double turn_penalty, int seed) {
+    std::mt19937 rng(seed * 7919 + settings.num_routes);
+    std::uniform_int_distribution<IntersectionIdx> random_intersection(0, getNumIntersections() - 1);
+
+    auto componentIntersection = [&]() {
+        IntersectionIdx intersection = random_intersection(rng);
+        while (get_intersection_component(intersection) != component) {
+            intersection = random_intersection(rng);
+        }
+        return intersection;
+    };
+
+    std::vector<std::pair<IntersectionIdx, IntersectionIdx>> queries;
+    for (int route = 0; route < settings.num_routes; route++) {
+        IntersectionIdx from = componentIntersection();
+        queries.push_back({from, componentIntersection()});
+    }
+
+    RouteResult result;
+    result.turn_penalty = turn_penalty;
+    result.seed = seed;
+    result.num_routes = settings.num_routes;
+
+    std::vector<std::vector<StreetSegmentIdx>> kernel_paths;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    for (const auto& query : queries) {
+        kernel_paths.push_back(findPathBetweenIntersections(turn_penalty, query));
+    }
+    result.kernel_time = secondsSince(start_time);
+
+    std::vector<std::vector<StreetSegmentIdx>> hand_written_paths;
+    start_time = std::chrono::high_resolution_clock::now();
+    for (const auto& query : queries) {
+        hand_written_paths.push_back(handWrittenRoute(query.first, query.second, turn_penalty));
+    }
+    result.hand_written_time = secondsSince(start_time);
+
+    result.mismatches = 0;
+    for (size_t route = 0; route < queries.size(); route++) {
+        double kernel_travel_time = computePathTravelTime(turn_penalty, kernel_paths[route]);
+        double hand_written_travel_time = computePathTravelTime(turn_penalty, hand_written_paths[route]);
+        if (std::abs(kernel_travel_time - hand_written_travel_time) > 1e-9 * std::max(1.0, hand_written_travel_time)) {
+            result.mismatches++;
+        }
+    }
+
+    // Every intersection both a pick up and a drop off, so every pair of the matrix is searched
+    std::vector<IntersectionIdx> matrix_intersections;
+    std::vector<DeliveryInf> deliveries;
+    for (int intersection = 0; intersection < MATRIX_INTERSECTIONS; intersection++) {
+        matrix_intersections.push_back(componentIntersection());
+    }
+    for (int intersection = 0; intersection < MATRIX_INTERSECTIONS; intersection++) {
+        deliveries.emplace_back(matrix_intersections[intersection], matrix_intersections[(intersection + 1) % MATRIX_INTERSECTIONS]);
+    }
+
+    start_time = std::chrono::high_resolution_clock::now();
+    computeCourierMatrix(deliveries, {}, turn_penalty);
+    result.matrix_kernel_time = secondsSince(start_time);
+
+    start_time = std::chrono::high_resolution_clock::now();
+    for (IntersectionIdx source : matrix_intersections) {
+        handWrittenAllPaths(source, matrix_intersections, turn_penalty);
+    }
+    result.matrix_hand_written_time = secondsSince(start_time);
+
+    return result;
+}
+
+long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// Whether every truck's route is legal for the deliveries it serves and every delivery is served
+// by exactly one truck. An instance's intersections are all different, so a delivery is served by
+// the truck whose route stops at its pick up
+bool fleetIsLegal(const std::vector<DeliveryInf>& deliveries,
+                  const std::vector<IntersectionIdx>& depots,
+                  const std::vector<std::vector<CourierSubPath>>& routes) {
+    if (routes.empty()) {
+        return false;
+    }
+
+    std::vector<int> times_served(deliveries.size(), 0);
+    for (const std::vector<CourierSubPath>& route : routes) {
+        std::unordered_set<IntersectionIdx> stops;
+        for (const CourierSubPath& subpath : route) {
+            stops.insert(subpath.intersections.first);
+        }
+
+        std::vector<DeliveryInf> served;
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (stops.count(deliveries[delivery].pickUp) > 0) {
+                served.push_back(deliveries[delivery]);
+                times_served[delivery]++;
+            }
+        }
+
+        if (!route.empty() && !ece297test::courier_path_is_legal(served, depots, route)) {
+            return false;
+        }
+    }
+
+    return std::all_of(times_served.begin(), times_served.end(), [](int times) { return times == 1; });
+}
+
+// One run of travelingCourier, or of travelingCourierFleet with num_vehicles trucks if that isn't 0
+BenchResult runInstance(const BenchSettings& settings, int component, int num_deliveries,
+                        int num_depots, int num_vehicles, double turn_penalty, int seed) {
+    std::vector<DeliveryInf> deliveries;
+    std::vector<IntersectionIdx> depots;
+    randomInstance(num_deliveries, num_depots, seed, component, deliveries, depots);
+
+    CourierStats stats;
+    CourierOptions options;
+    options.time_budget = settings.time_budget;
+    options.stats = &stats;
+    options.tour_search = settings.tour_search;
+
+    FleetOptions fleet;
+    fleet.num_vehicles = num_vehicles;
+    fleet.max_deliveries = settings.max_deliveries;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<CourierSubPath>> routes;
+    if (num_vehicles == 0) {
+        routes.push_back(travelingCourier(turn_penalty, deliveries, depots, options));
+    }
+    else {
+        routes = travelingCourierFleet(turn_penalty, deliveries, depots, fleet, options);
+    }
+    double total_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+
+    BenchResult result;
+    result.num_deliveries = num_deliveries;
+    result.num_depots = num_depots;
+    result.num_vehicles = num_vehicles;
+    result.turn_penalty = turn_penalty;
+    result.seed = seed;
+    result.threads = omp_get_max_threads();
+    result.search = (settings.tour_search == TourSearch::LARGE_NEIGHBOURHOOD) ? "lns" : "annealing";
+    result.legal = (num_vehicles == 0) ? ece297test::courier_path_is_legal(deliveries, depots, routes.front())
+                                       : fleetIsLegal(deliveries, depots, routes);
+    result.cost = 0;
+    if (result.legal) {
+        for (const std::vector<CourierSubPath>& route : routes) {
+            result.cost += ece297test::compute_courier_path_travel_time(route, turn_penalty);
+        }
+    }
+    result.precompute_time = stats.precompute_time;
+    result.total_time = total_time;
+    result.moves_per_second = (stats.annealing_time > 0) ? stats.annealing_moves / stats.annealing_time : 0;
+    result.model_error = result.legal ? result.cost - stats.tour_cost : 0;
+    result.peak_rss_kb = peakRssKb();
+    return result;
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "deliveries,depots,vehicles,turn_penalty,seed,threads,search,legal,cost,precompute_s,total_s,moves_per_s,model_error_s,peak_rss_kb\n";
+    for (const BenchResult& result : results) {
+        out << result.num_deliveries << "," << result.num_depots << "," << result.num_vehicles << "," << result.turn_penalty << ","
+            << result.seed << "," << result.threads << "," << result.search << "," << result.legal << ",";
+        if (result.legal) {
+            out << result.cost;
+        }
+        out << "," << result.precompute_time << "," << result.total_time << ","
+            << result.moves_per_second << "," << result.model_error << "," << result.peak_rss_kb << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "[\n";
+    for (size_t row = 0; row < results.size(); row++) {
+        const BenchResult& result = results[row];
+        out << "  {\"deliveries\": " << result.num_deliveries
+            << ", \"depots\": " << result.num_depots
+            << ", \"vehicles\": " << result.num_vehicles
+            << ", \"turn_penalty\": " << result.turn_penalty
+            << ", \"seed\": " << result.seed
+            << ", \"threads\": " << result.threads
+            << ", \"search\": \"" << result.search << "\""
+            << ", \"legal\": " << (result.legal ? "true" : "false")
+            << ", \"cost\": ";
+        if (result.legal) {
+            out << result.cost;
+        }
+        else {
+            out << "null";
+        }
+        out << ", \"precompute_s\": " << result.precompute_time
+            << ", \"total_s\": " << result.total_time
+            << ", \"moves_per_s\": " << result.moves_per_second
+            << ", \"model_error_s\": " << result.model_error
+            << ", \"peak_rss_kb\": " << result.peak_rss_kb
+            << "}" << (row + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+void writeCsv(std::ostream& out, const std::vector<RouteResult>& results) {
+    out << "turn_penalty,seed,routes,kernel_s,hand_written_s,mismatches,matrix_intersections,matrix_kernel_s,matrix_hand_written_s\n";
+    for (const RouteResult& result : results) {
+        out << result.turn_penalty << "," << result.seed << "," << result.num_routes << ","
+            << result.kernel_time << "," << result.hand_written_time << "," << result.mismatches << ","
+            << MATRIX_INTERSECTIONS << "," << result.matrix_kernel_time << "," << result.matrix_hand_written_time << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<RouteResult>& results) {
+    out << "[\n";
+    for (size_t row = 0; row < results.size(); row++) {
+        const RouteResult& result = results[row];
+        out << "  {\"turn_penalty\": " << result.turn_penalty
+            << ", \"seed\": " << result.seed
+            << ", \"routes\": " << result.num_routes
+            << ", \"kernel_s\": " << result.kernel_time
+            << ", \"hand_written_s\": " << result.hand_written_time
+            << ", \"mismatches\": " << result.mismatches
+            << ", \"matrix_intersections\": " << MATRIX_INTERSECTIONS
+            << ", \"matrix_kernel_s\": " << result.matrix_kernel_time
+            << ", \"matrix_hand_written_s\": " << result.matrix_hand_written_time
+            << "}" << (row + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+// Writes the rows to --out, or stdout without it
+template <class Result>
+int writeResults(const BenchSettings& settings, const std::vector<Result>& results) {
+    if (settings.out_path.empty()) {
+        (settings.format == "json") ? writeJson(std::cout, results) : writeCsv(std::cout, results);
+        return SUCCESS_EXIT_CODE;
+    }
+
+    std::ofstream out(settings.out_path);
+    if (!out) {
+        std::cerr << "Failed to open '" << settings.out_path << "'\n";
+        return ERROR_EXIT_CODE;
+    }
+    (settings.format == "json") ? writeJson(out, results) : writeCsv(out, results);
+    return SUCCESS_EXIT_CODE;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchSettings settings;
+    if (!parseSettings(argc, argv, settings)) {
+        std::cerr << "Usage: " << argv[0] << " <map_file_path> [--sizes 20,100,200] [--depots 3]"
+                  << " [--turn-penalties 15] [--seeds 3] [--budget " << TIME_LIMIT << "]"
+                  << " [--search annealing|lns] [--vehicles 1,4,8] [--max-deliveries 0]"
+                  << " [--routes 0] [--format csv|json] [--out file]\n";
+        std::cerr << "  Results go to stdout without --out.\n";
+        return BAD_ARGUMENTS_EXIT_CODE;
+    }
+
+    // Keep stdout for the results, whatever the map loader and solver print goes to stderr
+    std::streambuf* results_buffer = std::cout.rdbuf(std::cerr.rdbuf());
+
+    if (!loadMap(settings.map_path)) {
+        std::cerr << "Failed to load map '" << settings.map_path << "'\n";
+        return ERROR_EXIT_CODE;
+    }
+
+    int component_size = 0;
+    int component = largestComponent(component_size);
+
+    if (settings.num_routes > 0) {
+        std::vector<RouteResult> route_results;
+        for (double turn_penalty : settings.turn_penalties) {
+            for (int seed = 1; seed <= settings.num_seeds; seed++) {
+                route_results.push_back(runRoutes(settings, component, turn_penalty, seed));
+
+                const RouteResult& result = route_results.back();
+                std::cerr << "BENCH " << result.num_routes << " routes, turn penalty " << turn_penalty
+                          << ", seed " << seed << ": kernel " << result.kernel_time << " s, hand-written "
+                          << result.hand_written_time << " s" << std::endl;
+            }
+        }
+
+        closeMap();
+        std::cout.rdbuf(results_buffer);
+        return writeResults(settings, route_results);
+    }
+
+    // Every pick up, drop off and depot of an instance is a different intersection of the component
+    int most_intersections = 2 * *std::max_element(settings.sizes.begin(), settings.sizes.end()) +
+                             *std::max_element(settings.depot_counts.begin(), settings.depot_counts.end());
+    if (most_intersections > component_size) {
+        std::cerr << "The largest connected part of the map has " << component_size << " intersections, "
+                  << most_intersections << " are needed for the largest instance\n";
+        closeMap();
+        return ERROR_EXIT_CODE;
+    }
+
+    // 0 trucks is a travelingCourier run
+    std::vector<int> vehicle_counts = settings.vehicle_counts.empty() ? std::vector<int>{0} : settings.vehicle_counts;
+
+    // The trucks have to have room for every delivery
+    int fewest_vehicles = *std::min_element(vehicle_counts.begin(), vehicle_counts.end());
+    if (!settings.vehicle_counts.empty() && settings.max_deliveries > 0 &&
+        static_cast<long>(fewest_vehicles) * settings.max_deliveries < *std::max_element(settings.sizes.begin(), settings.sizes.end())) {
+        std::cerr << fewest_vehicles << " trucks taking " << settings.max_deliveries
+                  << " deliveries each can't serve the largest instance\n";
+        closeMap();
+        return ERROR_EXIT_CODE;
+    }
+
+    std::vector<BenchResult> results;
+    for (int num_deliveries : settings.sizes) {
+        for (int num_depots : settings.depot_counts) {
+            for (int num_vehicles : vehicle_counts) {
+                for (double turn_penalty : settings.turn_penalties) {
+                    for (int seed = 1; seed <= settings.num_seeds; seed++) {
+                        results.push_back(runInstance(settings, component, num_deliveries, num_depots, num_vehicles, turn_penalty, seed));
+
+                        const BenchResult& result = results.back();
+                        std::cerr << "BENCH " << num_deliveries << " deliveries, " << num_depots << " depots, "
+                                  << num_vehicles << " vehicles, turn penalty " << turn_penalty << ", seed " << seed << ": "
+                                  << (result.legal ? std::to_string(result.cost) : "INVALID") << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    closeMap();
+    std::cout.rdbuf(results_buffer);
+    return writeResults(settings, results);
+}
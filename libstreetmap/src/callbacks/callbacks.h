@@ -31,6 +31,9 @@ extern int search_mode;
 #define FASTEST_ROUTE 1
 #define DELIVERY 2
 
+// Milliseconds between redraws of the courier route while the solver runs
+#define COURIER_REDRAW_INTERVAL 200
+
 extern int start_idx, dest_idx;
 extern int start_idx_pt2, dest_idx_pt2;
 extern int intersections_clicked, intersection_1, intersection_2;
@@ -63,6 +66,7 @@ extern GtkButton *go_button;
 extern GtkButton *help_button;
 extern GtkButton *directions_button;
 extern GtkButton *clear_button;
+extern GtkButton *cancel_button;
 extern GtkListStore *Street_names_list;
 extern GtkTreeIter iter;
 extern GtkEntry *start_entry, *dest_entry, *start_entry_pt2, *dest_entry_pt2;
@@ -98,6 +102,13 @@ void on_combo_changed_2(GtkComboBox *widget, gpointer data);
 void act_on_help_button_click(GtkButton *help_button, ezgl::application *application);
 void act_on_directions_button_click(GtkButton *directions_button, ezgl::application *application);
 void act_on_clear_button_click(GtkButton *clear_button, ezgl::application *application);
+void act_on_cancel_button_click(GtkButton *cancel_button, ezgl::application *application);
+
+// Courier solver run from the Go button in delivery mode, see courier.cpp
+void start_courier_solver(ezgl::application *application);
+gboolean poll_courier_solver(gpointer data);
+void show_courier_solver_running(bool running);
+void stop_courier_solver();
 
 // Callbacks for search entry
 void act_on_search_match_selected(GtkEntry *entry, gpointer user_data, ezgl::application *application);
@@ -56,6 +56,10 @@ void act_on_clear_button_click(GtkButton * /*directions_button*/, ezgl::applicat
 
         depots_list.clear();
         deliveries_list.clear();
+
+        // Clear courier route drawn
+        path.clear();
+        display_path = false;
     }
 
     quiz_mode_path.clear();
@@ -0,0 +1,186 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: runs travelingCourier for the depots and deliveries picked in delivery mode on a
+ * worker thread, so the window keeps responding while it searches. Each better route the solver
+ * finds is left in a single slot (an atomic pointer the worker swaps new routes into and the GUI
+ * swaps out), and a GLib timeout draws whatever is in it every COURIER_REDRAW_INTERVAL ms.
+ * Routes the GUI didn't get to in time are skipped, only the newest one matters.
+*/
+
+#include "callbacks.h"
+#include "m4_helper/m4_helper.h"
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+// A route from the solver, handed over through courier_slot
+struct CourierRoute
+{
+    std::vector<CourierSubPath> subpaths;
+    double travel_time;
+
+    // The solver's answer rather than an improvement on the way to it
+    bool is_final;
+};
+
+// Courier Helper functions
+void publish_courier_route(CourierRoute *route);
+
+// Newest route not yet drawn, owned by whoever swaps it out
+std::atomic<CourierRoute *> courier_slot{nullptr};
+
+// Asks the solver to wrap up, and whether it has
+std::atomic<bool> courier_stop{false};
+std::atomic<bool> courier_done{false};
+
+std::thread courier_thread;
+
+// Timeout drawing the solver's routes, 0 when none is running
+guint courier_poll_source = 0;
+
+//---------------------------------------- Courier Callback Functions -----------------------------------------//
+
+// Replaces whatever route is waiting in the slot
+void publish_courier_route(CourierRoute *route)
+{
+    delete courier_slot.exchange(route, std::memory_order_acq_rel);
+}
+
+// Go and Clear wait while the solver runs, Cancel shows only then
+void show_courier_solver_running(bool running)
+{
+    gtk_widget_set_sensitive(GTK_WIDGET(go_button), !running);
+    gtk_widget_set_sensitive(GTK_WIDGET(clear_button), !running);
+    gtk_widget_set_visible(GTK_WIDGET(cancel_button), running);
+}
+
+// Starts the solver on the current depots and deliveries, unless it is already running
+void start_courier_solver(ezgl::application *application)
+{
+    if (courier_thread.joinable())
+    {
+        return;
+    }
+
+    if (depots_list.empty() || deliveries_list.empty())
+    {
+        application->create_popup_message_with_callback(act_on_popup_features_done_button, "Error: No deliveries", "Please select at least one depot and one delivery.");
+        return;
+    }
+
+    courier_stop = false;
+    courier_done = false;
+
+    // The worker gets its own copy, the lists can change under it while it runs
+    std::vector<DeliveryInf> deliveries = deliveries_list;
+    std::vector<IntersectionIdx> depots = depots_list;
+
+    courier_thread = std::thread([deliveries, depots]()
+    {
+        CourierOptions options;
+        options.stop = &courier_stop;
+        options.on_improvement = [](const std::vector<CourierSubPath> &subpaths, double travel_time)
+        {
+            publish_courier_route(new CourierRoute{subpaths, travel_time, false});
+        };
+
+        std::vector<CourierSubPath> route = travelingCourier(15, deliveries, depots, options);
+
+        double travel_time = 0;
+        for (const CourierSubPath &subpath : route)
+        {
+            travel_time += computePathTravelTime(15, subpath.subpath);
+        }
+        publish_courier_route(new CourierRoute{route, travel_time, true});
+        courier_done = true;
+    });
+
+    // No new search until this one is done
+    show_courier_solver_running(true);
+    application->update_message("Finding courier route...");
+
+    courier_poll_source = g_timeout_add(COURIER_REDRAW_INTERVAL, poll_courier_solver, application);
+}
+
+// Draws the newest route from the solver. Removes itself once the solver is done
+gboolean poll_courier_solver(gpointer data)
+{
+    ezgl::application *application = static_cast<ezgl::application *>(data);
+
+    // Read before emptying the slot, so a final route published after this is never missed
+    bool done = courier_done;
+
+    CourierRoute *route = courier_slot.exchange(nullptr, std::memory_order_acq_rel);
+
+    if (route != nullptr)
+    {
+        path.clear();
+        for (const CourierSubPath &subpath : route->subpaths)
+        {
+            path.insert(path.end(), subpath.subpath.begin(), subpath.subpath.end());
+        }
+        display_path = true;
+
+        std::stringstream ss;
+        if (!route->is_final)
+        {
+            ss << "Courier route so far: " << static_cast<int>(route->travel_time) << " s";
+            application->update_message(ss.str());
+        }
+        else if (route->subpaths.empty())
+        {
+            application->update_message("");
+            application->create_popup_message_with_callback(act_on_popup_features_done_button, "Error: No route", "No route reaches every delivery from a depot.");
+        }
+        else
+        {
+            ss << (courier_stop ? "Courier route (cancelled): " : "Courier route: ")
+               << static_cast<int>(route->travel_time) << " s";
+            application->update_message(ss.str());
+        }
+
+        delete route;
+        application->refresh_drawing();
+    }
+
+    if (!done)
+    {
+        return G_SOURCE_CONTINUE;
+    }
+
+    courier_thread.join();
+    courier_poll_source = 0;
+
+    show_courier_solver_running(false);
+    return G_SOURCE_REMOVE;
+}
+
+// Stops the solver early, the best route so far is still drawn
+void act_on_cancel_button_click(GtkButton * /*cancel_button*/, ezgl::application *application)
+{
+    courier_stop = true;
+    application->update_message("Cancelling courier route...");
+}
+
+// Stops the solver and waits for it, dropping its route and leaving the buttons as they are.
+// For when the map it searches goes away
+void stop_courier_solver()
+{
+    if (!courier_thread.joinable())
+    {
+        return;
+    }
+
+    courier_stop = true;
+    courier_thread.join();
+    delete courier_slot.exchange(nullptr, std::memory_order_acq_rel);
+
+    g_source_remove(courier_poll_source);
+    courier_poll_source = 0;
+}
+
+//-------------------------------------- End Courier Callback Functions ---------------------------------------//
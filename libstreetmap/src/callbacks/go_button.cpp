@@ -31,6 +31,14 @@ void act_on_go_button_click(GtkButton * /*go_button*/, ezgl::application *applic
 
     std::stringstream ss;
 
+    // In delivery mode, find a courier route through the depots and deliveries clicked on the map.
+    // The search runs in the background and draws its route as it improves
+    if (search_mode == DELIVERY)
+    {
+        start_courier_solver(application);
+        return;
+    }
+
     // Get the shared intersections between the 2 streets input in the first search bar
     start_entry = GTK_ENTRY(application->get_object("StartEntry"));
     dest_entry = GTK_ENTRY(application->get_object("DestEntry"));
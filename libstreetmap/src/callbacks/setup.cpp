@@ -61,6 +61,7 @@ GtkButton *go_button;
 GtkButton *help_button;
 GtkButton *directions_button;
 GtkButton *clear_button;
+GtkButton *cancel_button;
 GtkListStore *Street_names_list;
 GtkTreeIter iter;
 GtkEntry *start_entry, *dest_entry, *start_entry_pt2, *dest_entry_pt2;
@@ -137,6 +138,10 @@ void set_up_buttons(ezgl::application *application)
     clear_button = GTK_BUTTON(application->get_object("ClearButton"));
     gtk_widget_set_visible(GTK_WIDGET(clear_button), FALSE);
     g_signal_connect(clear_button, "clicked", G_CALLBACK(act_on_clear_button_click), application);
+
+    cancel_button = GTK_BUTTON(application->get_object("CancelButton"));
+    gtk_widget_set_visible(GTK_WIDGET(cancel_button), FALSE);
+    g_signal_connect(cancel_button, "clicked", G_CALLBACK(act_on_cancel_button_click), application);
 }
 
 // Get input from text boxes
@@ -240,6 +245,12 @@ void draw_new_map(GtkComboBoxText *self, ezgl::application *application)
 
     std::cout << "New map: " << str_id << std::endl;
 
+    // The courier solver searches the old map, and its route is made of the old map's street segments
+    stop_courier_solver();
+    show_courier_solver_running(false);
+    path.clear();
+    display_path = false;
+
     // Clear all graphics data, load new data
     closeMap();
     clear_map_data();
@@ -25,6 +25,8 @@
 #include "m1.h"
 #include "m1_helper/m1_helper.h"
 #include "m1_helper/m1_globals.h"
+#include "m3_helper/travel_profiles.h"
+#include "m3_helper/snap_to_road.h"
 
 #include <iostream>
 #include <unordered_map>
@@ -79,11 +81,28 @@ bool loadMap(std::string map_streets_database_filename) {
     // Load helper function calls that are related to the StreetsDatabase API
     all_street_database_API_members = new StreetDatabaseAPIMembers();
 
-    // Load helper function calls that are related to the OSMDatabase API
-    all_OSM_database_API_members = new OSMDatabaseAPIMembers();
-
-    // load speed limits for M3
+    // load speed limits for M3 (the driving profile's heuristic needs it)
     load_max_speed();
+
+    // Load helper function calls that are related to the OSMDatabase API, building the
+    // per-profile routing graphs and the segment spatial index at the same time (independent data)
+    #pragma omp parallel sections
+    {
+        #pragma omp section
+        {
+            all_OSM_database_API_members = new OSMDatabaseAPIMembers();
+        }
+
+        #pragma omp section
+        {
+            loadTravelProfiles();
+        }
+
+        #pragma omp section
+        {
+            loadSegmentSpatialIndex();
+        }
+    }
     
     // Returns true when everything has been successfully loade
     return true;
@@ -97,6 +116,8 @@ void closeMap() {
     // Clean-up map related data structures
     delete all_street_database_API_members;
     delete all_OSM_database_API_members;
+    clearTravelProfiles();
+    clearSegmentSpatialIndex();
     max_speed = 1;
 
     // Close OSM and Streets Databases
@@ -143,6 +164,10 @@ LatLon get_intersection_position(int intersection_id){
     return all_street_database_API_members->intersection_lat_lon[intersection_id];
 }
 
+const std::vector<StreetSegmentIdx>& get_intersection_street_segments(int intersection_id){
+    return all_street_database_API_members->intersection_street_segments[intersection_id];
+}
+
 // Returns the distance between two (lattitude,longitude) coordinates in meters.
 // Speed Requirement --> moderate 
 double findDistanceBetweenTwoPoints(LatLon point_1, LatLon point_2) { 
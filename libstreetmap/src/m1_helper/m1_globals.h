@@ -3,12 +3,15 @@
 
 #include "StreetsDatabaseAPI.h"
 
+#include <vector>
+
 float get_max_speed();
 int get_street_seg_street_id(int street_seg_id);
 int get_street_seg_from(int street_seg_id);
 int get_street_seg_to(int street_seg_id);
 bool get_street_seg_one_way(int street_seg_id);
 LatLon get_intersection_position(int intersection_id);
+const std::vector<StreetSegmentIdx>& get_intersection_street_segments(int intersection_id);
 
 
 #endif
\ No newline at end of file
@@ -55,6 +55,9 @@ void drawMap() {
 
     // Run the application
     application.run(initial_setup, act_on_mouse_click, act_on_mouse_move, nullptr);
+
+    // Don't leave a courier search running on a map about to be closed
+    stop_courier_solver();
 }
 
 //------------------------------------------- End Main function -------------------------------------------//
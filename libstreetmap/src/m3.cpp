@@ -12,12 +12,14 @@
 #include "m1.h"
 
 #include "m3_helper/m3_helper.h"
+#include "m3_helper/search_stats.h"
 #include "m1_helper/m1_globals.h"
 
 // Iterates through each street segment in the provided path, adding
 // up the time for each and adding turn penalties for each change of street.
 double computePathTravelTime(const double turn_penalty,
-                             const std::vector<StreetSegmentIdx> &path)
+                             const std::vector<StreetSegmentIdx> &path,
+                             TravelProfile profile)
 {
   double total_travel_time = 0.0;
 
@@ -29,14 +31,14 @@ double computePathTravelTime(const double turn_penalty,
   StreetSegmentIdx prev_segment_id = path[0];
 
   // Add travel time for the first street segment
-  total_travel_time += findStreetSegmentTravelTime(prev_segment_id);
+  total_travel_time += findStreetSegmentTravelTime(prev_segment_id, profile);
 
   // Loop through remaining
   for (size_t i = 1; i < path.size(); ++i)
   {
 
     StreetSegmentIdx current_segment_id = path[i];
-    total_travel_time += findStreetSegmentTravelTime(current_segment_id);
+    total_travel_time += findStreetSegmentTravelTime(current_segment_id, profile);
 
     // Check if there is a turn and add turn penalty
     if (get_street_seg_street_id(prev_segment_id) != get_street_seg_street_id(current_segment_id))
@@ -51,17 +53,52 @@ double computePathTravelTime(const double turn_penalty,
   return total_travel_time;
 }
 
+double computePathTravelTime(const double turn_penalty,
+                             const std::vector<StreetSegmentIdx> &path)
+{
+  return computePathTravelTime(turn_penalty, path, DRIVING);
+}
+
 // Finds a path between 2 intersections by calling bfsPath that uses Dijkstra's
 // algorithm from first to end intersection. If path found, traces back using
 // bfsTraceBack function that returns vector of street segment indexes.
-std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty, const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids)
+std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty, const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids, TravelProfile profile)
 {
-  bool found = bfsPath(intersect_ids.first, intersect_ids.second, turn_penalty);
+  bool found = bfsPath(intersect_ids.first, intersect_ids.second, turn_penalty, profile);
 
+  std::vector<StreetSegmentIdx> path;
   if (found)
   {
-    return bfsTraceBack(intersect_ids.second);
+    path = bfsTraceBack(intersect_ids.second);
+  }
+
+#ifdef ROUTING_STATS
+  // Per query dump, one JSON object per line
+  dumpLastSearchStats(std::clog);
+#endif
+
+  return path;
+}
+
+std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty, const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids)
+{
+  return findPathBetweenIntersections(turn_penalty, intersect_ids, DRIVING);
+}
+
+// Each thread has its own search workspace, so the queries are independent. Dynamic
+// scheduling since query times vary a lot with distance.
+std::vector<std::vector<StreetSegmentIdx>> findPathsBetweenIntersections(const double turn_penalty, const std::vector<std::pair<IntersectionIdx, IntersectionIdx>>& queries, TravelProfile profile)
+{
+  std::vector<std::vector<StreetSegmentIdx>> paths(queries.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t query = 0; query < queries.size(); query++)
+  {
+    if (bfsPath(queries[query].first, queries[query].second, turn_penalty, profile))
+    {
+      paths[query] = bfsTraceBack(queries[query].second);
+    }
   }
 
-  return {};
-}
\ No newline at end of file
+  return paths;
+}
@@ -4,8 +4,8 @@
  * Date: 25/03/2024
  *
  * Description: Contains helper functions for pathfinding required in M3.
- * The two functions are for performing BFS using Dijkstra's algorithm
- * and tracing back the shortest path found.
+ * The searches are specializations of the kernel in search_kernel.h,
+ * plus tracing back the shortest path found.
  */
 
 #include "m3_helper.h"
@@ -13,102 +13,102 @@
 #include "StreetsDatabaseAPI.h"
 #include "m1.h"
 #include "m1_globals.h"
+#include "search_kernel.h"
+#include "search_stats.h"
 #include <list>
-#include <queue>
 
-// Global vector to store node information during BFS
-std::vector<Node> nodes;
+// Node information during BFS, one workspace per thread
+thread_local SearchWorkspace search_workspace;
+
+SearchWorkspace& threadSearchWorkspace() {
+    return search_workspace;
+}
+
+// Clears only the nodes the previous search settled (or everything if the map changed size)
+void SearchWorkspace::reset(int num_nodes) {
+    if (nodes.size() != static_cast<size_t>(num_nodes)) {
+        nodes.assign(num_nodes, Node());
+    }
+    else {
+        for (IntersectionIdx node : settled) {
+            nodes[node] = Node();
+        }
+    }
+    settled.clear();
+}
 
 // Does a BFs from source intersection to a destination
-// finding shortest path using Dijkstra's algorithm.
-bool bfsPath(const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty) {
+// finding shortest path using A* (the GUI route specialization of the search kernel).
+bool bfsPath(const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty, TravelProfile profile) {
+
+    SEARCH_STATS_RESET();
 
-    nodes.resize(getNumIntersections());
+    // Skip the search when the component labels already rule out a path
+    if (!pathMayExist(srcID, destID, profile)) {
+        return false;
+    }
 
-    // Priority queue to store wavefront intersections to search
-    std::priority_queue<WaveElem, std::vector<WaveElem>, std::greater<WaveElem>> wavefront;
-    wavefront.push(WaveElem(srcID, NO_EDGE, 0, 0)); 
+    // Segment times and access of the chosen travel mode
+    const ProfileGraph& graph = get_profile_graph(profile);
 
-    bool pathFound = false;
+    GoalStop stop_rule(destID);
+    runSearch<BinaryHeapQueue>(search_workspace, {WaveElem(srcID, NO_EDGE, 0, 0)}, graph,
+                               GoalHeuristic(get_intersection_position(destID), graph.max_speed), turn_penalty, stop_rule);
 
-    // Perform BFS until wavefront is empty
-    while (wavefront.size() > 0)
-    {
-        // Get the intersection at the front of the wavefront
-        WaveElem curr = wavefront.top(); 
-        wavefront.pop();                
+    return search_workspace.nodes[destID].bestTime != DBL_MAX;
+}
 
-        // Check if this is a better path to the current node
-        if (curr.travelTime < nodes[curr.nodeID].bestTime && curr.travelTime < nodes[destID].bestTime)
-        {
-            // Update best time and reaching edge for the current node
-            nodes[curr.nodeID].reachingEdge = curr.edgeID;
-            nodes[curr.nodeID].bestTime = curr.travelTime;
-
-            // Check if destination reached
-            if (curr.nodeID == destID)
-            {
-                pathFound = true;
-            }
-
-            else
-            {
-                // Get outgoing segments of the current intersection
-                nodes[curr.nodeID].out_edges = findStreetSegmentsOfIntersection(curr.nodeID);
-
-                // Explore each outgoing segment
-                for (StreetSegmentIdx out_edge : nodes[curr.nodeID].out_edges)
-                {
-                    int toNodeID = 0;
-
-                    // Determine ID of intersection 9accounting for one-way)
-                    if (curr.nodeID == get_street_seg_from(out_edge))
-                    {
-                        toNodeID = get_street_seg_to(out_edge);
-                    }
-                    else if (!get_street_seg_one_way(out_edge) && (curr.nodeID == get_street_seg_to(out_edge)))
-                    {
-                        toNodeID = get_street_seg_from(out_edge);
-                    }
-                    else
-                    {
-                        continue;
-                    }
-
-                    // Calculate travel time to the reached intersection
-                    double travelTime;
-                    if (nodes[curr.nodeID].reachingEdge != NO_EDGE && get_street_seg_street_id(nodes[curr.nodeID].reachingEdge) != get_street_seg_street_id(out_edge))
-                    {
-                        // Add turn penalty if changing streets
-                        travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge) + turn_penalty;
-                    }
-                    else
-                    {
-                        travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge);
-                    }
-
-                    if (travelTime < nodes[toNodeID].bestTime) {
-
-                        // Calculate heuristic value for priority queue and add intersection to wavefront
-                        double heuristic = findDistanceBetweenTwoPoints(get_intersection_position(toNodeID), get_intersection_position(destID)) / get_max_speed();
-                        wavefront.push(WaveElem(toNodeID, out_edge, travelTime, heuristic)); 
-                    }
-                }
-            }
-        }
+
+
+// Does an A* search from every seed at once, finishing at whichever target gives the
+// fastest arrival at the goal position. Used when routing from / to mid-segment positions.
+int bfsPathFromSeeds(const std::vector<WaveElem>& seeds, const std::vector<SearchTarget>& targets, LatLon goal, const double turn_penalty, TravelProfile profile, double& totalTime) {
+
+    SEARCH_STATS_RESET();
+
+    const ProfileGraph& graph = get_profile_graph(profile);
+
+    TargetsStop stop_rule(targets, turn_penalty, totalTime);
+    runSearch<BinaryHeapQueue>(search_workspace, seeds, graph, GoalHeuristic(goal, graph.max_speed), turn_penalty, stop_rule);
+
+    totalTime = stop_rule.totalTime;
+    return stop_rule.bestTarget;
+}
+
+
+
+// Dijkstra from srcID that never relaxes past the time limit (the isochrone specialization).
+std::vector<std::pair<IntersectionIdx, double>> findIntersectionsWithinTime(const IntersectionIdx srcID, const double time_limit, const double turn_penalty, TravelProfile profile) {
+
+    SEARCH_STATS_RESET();
+
+    TimeLimitStop stop_rule(time_limit);
+    runSearch<BinaryHeapQueue>(search_workspace, {WaveElem(srcID, NO_EDGE, 0, 0)}, get_profile_graph(profile),
+                               NoHeuristic(), turn_penalty, stop_rule);
+
+    std::vector<std::pair<IntersectionIdx, double>> reachable;
+    reachable.reserve(search_workspace.settled.size());
+
+    for (IntersectionIdx node : search_workspace.settled) {
+        reachable.push_back({node, search_workspace.nodes[node].bestTime});
     }
 
-    return pathFound;
+    return reachable;
 }
 
 
 
 // Traces back from the destination intersection to the starting
 // intersection using reachingEdge information for each node.
-std::vector<StreetSegmentIdx> bfsTraceBack(IntersectionIdx destID)
+// Stops early (keeping it) once stopEdge is reached, for searches seeded mid-segment.
+std::vector<StreetSegmentIdx> bfsTraceBack(IntersectionIdx destID, StreetSegmentIdx stopEdge)
 {
+    SEARCH_STATS_TIMER(traceback_start);
+
     std::list<StreetSegmentIdx> path;
 
+    const std::vector<Node>& nodes = search_workspace.nodes;
+
     IntersectionIdx currNodeID = destID;
 
     StreetSegmentIdx prevEdge = nodes[currNodeID].reachingEdge;
@@ -119,6 +119,11 @@ std::vector<StreetSegmentIdx> bfsTraceBack(IntersectionIdx destID)
         // Add the previous edge to front of path list
         path.push_front(prevEdge);
 
+        if (prevEdge == stopEdge)
+        {
+            break;
+        }
+
         // Update the current intersection
         if (currNodeID == get_street_seg_from(prevEdge))
         {
@@ -133,7 +138,7 @@ std::vector<StreetSegmentIdx> bfsTraceBack(IntersectionIdx destID)
         prevEdge = nodes[currNodeID].reachingEdge;
     }
 
-    nodes.clear();
+    SEARCH_STATS_ELAPSED(traceback_time, traceback_start);
 
     return {std::begin(path), std::end(path)};
 }
@@ -7,10 +7,14 @@
  * and provides function declarations for bfsPath and bfsTraceBack.
  */
 
+#ifndef M3_HELPER_H
+#define M3_HELPER_H
+
 #include <vector>
 #include <float.h>
 
 #include "StreetsDatabaseAPI.h"
+#include "travel_profiles.h"
 
 // Illegal edge ID -> no edge 
 #define NO_EDGE -1  
@@ -47,10 +51,6 @@ struct WaveElem {
 
 // A node in the graph for pathfinding
 struct Node {
-   bool found = false;
-   // Outgoing edges
-   std::vector <StreetSegmentIdx> out_edges; 
-
    // Edge used to reach this node 
    StreetSegmentIdx reachingEdge = NO_EDGE;    
 
@@ -59,6 +59,35 @@ struct Node {
 };
 
 
+// Intersection a seeded search may finish at, with the time left from there to the goal
+struct SearchTarget {
+   IntersectionIdx nodeID;
+   double remainingTime;
+
+   // Edge travelled from the intersection to the goal (for the turn penalty),
+   // NO_EDGE if the goal is the intersection itself
+   StreetSegmentIdx finalEdge;
+};
+
+
 // Function declarations for BFS
-bool bfsPath (const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty);
-std::vector<StreetSegmentIdx> bfsTraceBack (int destID);
+bool bfsPath (const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty, TravelProfile profile = DRIVING);
+std::vector<StreetSegmentIdx> bfsTraceBack (int destID, StreetSegmentIdx stopEdge = NO_EDGE);
+
+// A* started from several intersections at once (seeds carry their start time and reaching edge)
+// towards a goal position reachable from any of the targets. totalTime holds a time already known
+// without searching (DBL_MAX if none) and is lowered to the best found; returns the index of the
+// target used, or -1 if the search found nothing faster
+int bfsPathFromSeeds (const std::vector<WaveElem>& seeds, const std::vector<SearchTarget>& targets, LatLon goal, const double turn_penalty, TravelProfile profile, double& totalTime);
+
+// Every intersection reachable from srcID within time_limit seconds, with its travel time
+std::vector<std::pair<IntersectionIdx, double>> findIntersectionsWithinTime(const IntersectionIdx srcID, const double time_limit, const double turn_penalty, TravelProfile profile = DRIVING);
+
+// Profile aware versions of the M3 API, the M3 signatures use DRIVING
+double computePathTravelTime(const double turn_penalty, const std::vector<StreetSegmentIdx>& path, TravelProfile profile);
+std::vector<StreetSegmentIdx> findPathBetweenIntersections(const double turn_penalty, const std::pair<IntersectionIdx, IntersectionIdx> intersect_ids, TravelProfile profile);
+
+// Answers many independent path queries in parallel, one path per query (empty if none)
+std::vector<std::vector<StreetSegmentIdx>> findPathsBetweenIntersections(const double turn_penalty, const std::vector<std::pair<IntersectionIdx, IntersectionIdx>>& queries, TravelProfile profile = DRIVING);
+
+#endif
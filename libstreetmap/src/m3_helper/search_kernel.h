@@ -0,0 +1,341 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Single A* / Dijkstra search loop shared by every router.
+ * The loop is a template over four policies so each use gets its own
+ * specialized code, with no runtime checks on the hot relaxation path:
+ *
+ *   Heuristic - estimated time left from an intersection (NoHeuristic makes it Dijkstra)
+ *   TurnRule  - extra time when moving from one segment to the next
+ *   StopRule  - which popped elements to drop, which settled nodes to expand,
+ *               which relaxations to keep and when the whole search is done
+ *   Queue     - wavefront container (push / top / pop / empty)
+ *
+ * Uses: bfsPath (GUI route), bfsPathFromSeeds (mid-segment route),
+ * searchCourierMatrixRow (courier matrix), findIntersectionsWithinTime
+ * (isochrone) and findPathsBetweenIntersections (parallel batch).
+ */
+
+#ifndef SEARCH_KERNEL_H
+#define SEARCH_KERNEL_H
+
+#include <algorithm>
+#include <queue>
+#include <vector>
+
+#include "StreetsDatabaseAPI.h"
+#include "m1.h"
+#include "m1_globals.h"
+#include "m3_helper.h"
+#include "search_stats.h"
+#include "travel_profiles.h"
+
+/**********************************Search State************************************/
+
+// Node state of one search. Only the settled nodes are reset before the next search,
+// so back to back queries don't pay for the whole map each time
+struct SearchWorkspace {
+   std::vector<Node> nodes;
+
+   // Every node settled since the last reset
+   std::vector<IntersectionIdx> settled;
+
+   // Sizes the workspace for num_nodes and clears the previous search
+   void reset(int num_nodes);
+};
+
+// Workspace of the calling thread, so searches on different threads never share state
+SearchWorkspace& threadSearchWorkspace();
+
+/*******************************Heuristic Policies*********************************/
+
+// Dijkstra: no estimate
+struct NoHeuristic {
+   double operator()(IntersectionIdx) const {
+      return 0;
+   }
+};
+
+// A*: straight line distance to the goal at the fastest speed of the profile
+struct GoalHeuristic {
+   LatLon goal;
+   double max_speed;
+
+   GoalHeuristic(LatLon g, double speed) : goal(g), max_speed(speed) {}
+
+   double operator()(IntersectionIdx node) const {
+      return findDistanceBetweenTwoPoints(get_intersection_position(node), goal) / max_speed;
+   }
+};
+
+/*********************************Turn Policies************************************/
+
+// Turns are free
+struct NoTurnPenalty {
+   double operator()(double travelTime, StreetSegmentIdx, StreetSegmentIdx) const {
+      return travelTime;
+   }
+};
+
+// Fixed penalty whenever the path changes street
+struct StreetChangePenalty {
+   double penalty;
+
+   explicit StreetChangePenalty(double p) : penalty(p) {}
+
+   double operator()(double travelTime, StreetSegmentIdx fromEdge, StreetSegmentIdx toEdge) const {
+      if (fromEdge != NO_EDGE && get_street_seg_street_id(fromEdge) != get_street_seg_street_id(toEdge)) {
+         return travelTime + penalty;
+      }
+      return travelTime;
+   }
+};
+
+/*********************************Stop Policies************************************/
+
+// Full shortest path tree from the sources
+struct ExhaustiveStop {
+   bool finished(const WaveElem&) const { return false; }
+   bool skip(const WaveElem&, const std::vector<Node>&) const { return false; }
+   bool settle(const WaveElem&) { return true; }
+   bool admit(double) const { return true; }
+};
+
+// Single destination: nothing slower than the best time found to it is explored,
+// and the destination itself is never expanded
+struct GoalStop {
+   IntersectionIdx goal;
+
+   explicit GoalStop(IntersectionIdx g) : goal(g) {}
+
+   bool finished(const WaveElem&) const { return false; }
+   bool skip(const WaveElem& curr, const std::vector<Node>& nodes) const { return curr.travelTime >= nodes[goal].bestTime; }
+   bool settle(const WaveElem& curr) { return curr.nodeID != goal; }
+   bool admit(double) const { return true; }
+};
+
+// Isochrone: only intersections reachable within the time limit
+struct TimeLimitStop {
+   double time_limit;
+
+   explicit TimeLimitStop(double limit) : time_limit(limit) {}
+
+   bool finished(const WaveElem&) const { return false; }
+   bool skip(const WaveElem&, const std::vector<Node>&) const { return false; }
+   bool settle(const WaveElem&) { return true; }
+   bool admit(double travelTime) const { return travelTime <= time_limit; }
+};
+
+// Goal position reachable from several target intersections (see bfsPathFromSeeds).
+// Done once nothing left in the wavefront can beat the best arrival
+struct TargetsStop {
+   const std::vector<SearchTarget>& targets;
+   double turn_penalty;
+
+   // Best arrival at the goal and the target it came through (-1 if none yet)
+   double totalTime;
+   int bestTarget = -1;
+
+   TargetsStop(const std::vector<SearchTarget>& t, double penalty, double known_time)
+      : targets(t), turn_penalty(penalty), totalTime(known_time) {}
+
+   bool finished(const WaveElem& curr) const { return curr.travelTime + curr.heuristic >= totalTime; }
+   bool skip(const WaveElem&, const std::vector<Node>&) const { return false; }
+   bool admit(double) const { return true; }
+
+   // Check if finishing from this intersection is the best arrival so far
+   bool settle(const WaveElem& curr) {
+      for (size_t target = 0; target < targets.size(); target++) {
+         if (targets[target].nodeID != curr.nodeID) {
+            continue;
+         }
+
+         double arrival = curr.travelTime + targets[target].remainingTime;
+         if (curr.edgeID != NO_EDGE && targets[target].finalEdge != NO_EDGE &&
+             get_street_seg_street_id(curr.edgeID) != get_street_seg_street_id(targets[target].finalEdge)) {
+            arrival += turn_penalty;
+         }
+
+         if (arrival < totalTime) {
+            totalTime = arrival;
+            bestTarget = static_cast<int>(target);
+         }
+      }
+      return true;
+   }
+};
+
+// Many destinations (a courier matrix row): done once every target is settled, rather
+// than after the whole map. is_target flags the targets by intersection
+struct AllTargetsStop {
+   const std::vector<char>& is_target;
+   int remaining;
+
+   AllTargetsStop(const std::vector<char>& targets, int num_targets)
+      : is_target(targets), remaining(num_targets) {}
+
+   bool finished(const WaveElem&) const { return remaining == 0; }
+   bool skip(const WaveElem&, const std::vector<Node>&) const { return false; }
+   bool admit(double) const { return true; }
+
+   bool settle(const WaveElem& curr) {
+      if (is_target[curr.nodeID]) {
+         remaining--;
+      }
+      return true;
+   }
+};
+
+/*********************************Queue Policies***********************************/
+
+// std::priority_queue ordered by travel time + heuristic
+typedef std::priority_queue<WaveElem, std::vector<WaveElem>, std::greater<WaveElem>> BinaryHeapQueue;
+
+// 4-ary min heap: shallower than a binary heap, and a node's children share a cache line
+struct QuadHeapQueue {
+   std::vector<WaveElem> heap;
+
+   bool empty() const { return heap.empty(); }
+   const WaveElem& top() const { return heap.front(); }
+
+   void push(const WaveElem& elem) {
+      size_t pos = heap.size();
+      heap.push_back(elem);
+
+      // Sift up
+      while (pos > 0 && heap[(pos - 1) / 4] > elem) {
+         heap[pos] = heap[(pos - 1) / 4];
+         pos = (pos - 1) / 4;
+      }
+      heap[pos] = elem;
+   }
+
+   void pop() {
+      WaveElem last = heap.back();
+      heap.pop_back();
+      if (heap.empty()) {
+         return;
+      }
+
+      // Sift the last element down from the root
+      size_t pos = 0;
+      while (true) {
+         size_t first_child = 4 * pos + 1;
+         if (first_child >= heap.size()) {
+            break;
+         }
+
+         size_t best_child = first_child;
+         size_t last_child = std::min(first_child + 4, heap.size());
+         for (size_t child = first_child + 1; child < last_child; child++) {
+            if (heap[best_child] > heap[child]) {
+               best_child = child;
+            }
+         }
+
+         if (!(last > heap[best_child])) {
+            break;
+         }
+         heap[pos] = heap[best_child];
+         pos = best_child;
+      }
+      heap[pos] = last;
+   }
+};
+
+/**********************************Search Kernel***********************************/
+
+// Searches from every seed at once over the profile's graph. Results are left in
+// workspace.nodes (best time and reaching edge of every settled node)
+template <class Queue, class Heuristic, class TurnRule, class StopRule>
+void searchKernel(SearchWorkspace& workspace, const std::vector<WaveElem>& seeds, const ProfileGraph& graph,
+                  const Heuristic& heuristic, const TurnRule& turn_rule, StopRule& stop_rule) {
+
+   SEARCH_STATS_TIMER(setup_start);
+
+   workspace.reset(getNumIntersections());
+   std::vector<Node>& nodes = workspace.nodes;
+
+   SEARCH_STATS_ELAPSED(setup_time, setup_start);
+   SEARCH_STATS_TIMER(search_start);
+
+   Queue wavefront;
+   for (const WaveElem& seed : seeds) {
+      wavefront.push(WaveElem(seed.nodeID, seed.edgeID, seed.travelTime, heuristic(seed.nodeID)));
+      SEARCH_STATS_COUNT(queue_pushes);
+   }
+
+   while (!wavefront.empty()) {
+      WaveElem curr = wavefront.top();
+      wavefront.pop();
+      SEARCH_STATS_COUNT(queue_pops);
+
+      if (stop_rule.finished(curr)) {
+         break;
+      }
+
+      // Only settle on a better path to this node
+      if (curr.travelTime >= nodes[curr.nodeID].bestTime || stop_rule.skip(curr, nodes)) {
+         continue;
+      }
+
+      SEARCH_STATS_COUNT(nodes_settled);
+
+      if (nodes[curr.nodeID].bestTime == DBL_MAX) {
+         workspace.settled.push_back(curr.nodeID);
+      }
+      nodes[curr.nodeID].reachingEdge = curr.edgeID;
+      nodes[curr.nodeID].bestTime = curr.travelTime;
+
+      if (!stop_rule.settle(curr)) {
+         continue;
+      }
+
+      // Explore each outgoing segment the profile may use
+      for (StreetSegmentIdx out_edge : get_intersection_street_segments(curr.nodeID)) {
+         SEARCH_STATS_COUNT(edges_relaxed);
+         IntersectionIdx toNodeID = 0;
+         double segTime = NO_ACCESS;
+
+         if (curr.nodeID == get_street_seg_from(out_edge)) {
+            toNodeID = get_street_seg_to(out_edge);
+            segTime = graph.forward_time[out_edge];
+         }
+         else if (curr.nodeID == get_street_seg_to(out_edge)) {
+            toNodeID = get_street_seg_from(out_edge);
+            segTime = graph.backward_time[out_edge];
+         }
+
+         if (segTime == NO_ACCESS) {
+            continue;
+         }
+
+         double travelTime = turn_rule(curr.travelTime + segTime, curr.edgeID, out_edge);
+
+         if (travelTime < nodes[toNodeID].bestTime && stop_rule.admit(travelTime)) {
+            wavefront.push(WaveElem(toNodeID, out_edge, travelTime, heuristic(toNodeID)));
+            SEARCH_STATS_COUNT(queue_pushes);
+         }
+      }
+   }
+
+   SEARCH_STATS_ELAPSED(search_time, search_start);
+}
+
+// Picks the turn rule at compile time, so searches without a penalty never look at street ids
+template <class Queue, class Heuristic, class StopRule>
+void runSearch(SearchWorkspace& workspace, const std::vector<WaveElem>& seeds, const ProfileGraph& graph,
+               const Heuristic& heuristic, const double turn_penalty, StopRule& stop_rule) {
+   if (turn_penalty == 0) {
+      searchKernel<Queue>(workspace, seeds, graph, heuristic, NoTurnPenalty(), stop_rule);
+   }
+   else {
+      searchKernel<Queue>(workspace, seeds, graph, heuristic, StreetChangePenalty(turn_penalty), stop_rule);
+   }
+}
+
+/********************************End Search Kernel*********************************/
+
+#endif
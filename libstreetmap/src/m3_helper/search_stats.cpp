@@ -0,0 +1,48 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Storage and JSON output for the search instrumentation
+ * declared in search_stats.h.
+ */
+
+#include "search_stats.h"
+
+#include <sstream>
+
+// One record per thread so parallel matrix searches don't share counters
+thread_local SearchStats last_search_stats;
+
+// Clear all counters and timings
+void SearchStats::reset() {
+    *this = SearchStats();
+}
+
+// One line JSON object holding every field
+std::string SearchStats::toJson() const {
+    std::stringstream ss;
+
+    ss << "{\"nodes_settled\": " << nodes_settled
+       << ", \"edges_relaxed\": " << edges_relaxed
+       << ", \"queue_pushes\": " << queue_pushes
+       << ", \"queue_pops\": " << queue_pops
+       << ", \"setup_time\": " << setup_time
+       << ", \"search_time\": " << search_time
+       << ", \"traceback_time\": " << traceback_time
+       << "}";
+
+    return ss.str();
+}
+
+const SearchStats& getLastSearchStats() {
+    return last_search_stats;
+}
+
+void dumpLastSearchStats(std::ostream& os) {
+    os << last_search_stats.toJson() << std::endl;
+}
+
+SearchStats& lastSearchStatsForUpdate() {
+    return last_search_stats;
+}
@@ -0,0 +1,75 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Opt-in instrumentation for the pathfinding search core. Counts
+ * settled nodes, relaxed edges and queue traffic, and times the workspace
+ * setup, search and trace back phases of each query.
+ *
+ * Stats are only collected when built with -DROUTING_STATS
+ * (e.g. make CXXFLAGS=-DROUTING_STATS); otherwise every SEARCH_STATS_* macro
+ * compiles to nothing and getLastSearchStats() always returns zeros.
+ */
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+// Counters and phase timings for a single search
+struct SearchStats {
+
+   // Nodes whose best time was finalized (popped with an improving time)
+   long nodes_settled = 0;
+
+   // Outgoing edges examined from settled nodes
+   long edges_relaxed = 0;
+
+   // Wavefront traffic
+   long queue_pushes = 0;
+   long queue_pops = 0;
+
+   // Phase timings, in seconds
+   double setup_time = 0;
+   double search_time = 0;
+   double traceback_time = 0;
+
+   // Clear all counters and timings
+   void reset();
+
+   // One line JSON object holding every field
+   std::string toJson() const;
+};
+
+// Stats of the most recent search run on the calling thread
+const SearchStats& getLastSearchStats();
+
+// Writes the stats of the most recent search on the calling thread as JSON
+void dumpLastSearchStats(std::ostream& os);
+
+// Mutable access used by the SEARCH_STATS_* macros
+SearchStats& lastSearchStatsForUpdate();
+
+#ifdef ROUTING_STATS
+
+#define SEARCH_STATS_RESET() lastSearchStatsForUpdate().reset()
+#define SEARCH_STATS_COUNT(field) (lastSearchStatsForUpdate().field++)
+#define SEARCH_STATS_ADD(field, amount) (lastSearchStatsForUpdate().field += (amount))
+#define SEARCH_STATS_TIMER(name) const auto name = std::chrono::high_resolution_clock::now()
+#define SEARCH_STATS_ELAPSED(field, name) \
+   (lastSearchStatsForUpdate().field += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - (name)).count())
+
+#else
+
+#define SEARCH_STATS_RESET() ((void)0)
+#define SEARCH_STATS_COUNT(field) ((void)0)
+#define SEARCH_STATS_ADD(field, amount) ((void)0)
+#define SEARCH_STATS_TIMER(name) ((void)0)
+#define SEARCH_STATS_ELAPSED(field, name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,364 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Segment spatial index and mid-segment routing declared in
+ * snap_to_road.h. Positions are projected to meters around the map's centre
+ * latitude (same projection as coordsToMeters) so the grid cells are square.
+ */
+
+#include "snap_to_road.h"
+#include "m3_helper.h"
+#include "m1.h"
+#include "m1_globals.h"
+
+#include <algorithm>
+#include <cmath>
+
+// A polyline point projected to meters
+struct MeterPoint {
+    double x, y;
+};
+
+// Uniform grid over the map, each cell listing the segments whose polyline passes through it
+struct SegmentSpatialIndex {
+
+    // Projection used for every point
+    double cos_lat = 1;
+
+    // Bottom left corner of the grid and its size in cells
+    double min_x = 0, min_y = 0;
+    int num_cols = 0, num_rows = 0;
+
+    // Polyline of each segment (from, curve points, to), flattened
+    std::vector<MeterPoint> seg_points;
+    std::vector<int> seg_point_start;
+
+    // Cumulative length of each segment's polyline at each of its points
+    std::vector<double> seg_point_distance;
+
+    // Segments of each cell, flattened
+    std::vector<StreetSegmentIdx> cell_segments;
+    std::vector<int> cell_start;
+};
+
+SegmentSpatialIndex segment_index;
+
+MeterPoint toMeters(LatLon position);
+LatLon fromMeters(MeterPoint point);
+int cellCol(double x);
+int cellRow(double y);
+void snapToSegment(MeterPoint query, StreetSegmentIdx seg, SnappedPoint& best, double& best_along);
+
+// Projects a position with the index's projection
+MeterPoint toMeters(LatLon position) {
+    return {kEarthRadiusInMeters * kDegreeToRadian * position.longitude() * segment_index.cos_lat,
+            kEarthRadiusInMeters * kDegreeToRadian * position.latitude()};
+}
+
+// Inverse of toMeters
+LatLon fromMeters(MeterPoint point) {
+    return LatLon(point.y / (kEarthRadiusInMeters * kDegreeToRadian),
+                  point.x / (kEarthRadiusInMeters * kDegreeToRadian * segment_index.cos_lat));
+}
+
+// Cell column / row of a coordinate, clamped to the grid (before the cast, so any coordinate fits)
+int cellCol(double x) {
+    return static_cast<int>(std::clamp(floor((x - segment_index.min_x) / SNAP_CELL_SIZE), 0.0, segment_index.num_cols - 1.0));
+}
+
+int cellRow(double y) {
+    return static_cast<int>(std::clamp(floor((y - segment_index.min_y) / SNAP_CELL_SIZE), 0.0, segment_index.num_rows - 1.0));
+}
+
+// Projects every segment polyline and buckets the segments into grid cells
+void loadSegmentSpatialIndex() {
+    int num_segments = getNumStreetSegments();
+    segment_index = SegmentSpatialIndex();
+
+    // Centre the projection on the map so distortion stays small
+    double min_lat = 90, max_lat = -90;
+    for (int intersection = 0; intersection < getNumIntersections(); intersection++) {
+        min_lat = std::min(min_lat, static_cast<double>(getIntersectionPosition(intersection).latitude()));
+        max_lat = std::max(max_lat, static_cast<double>(getIntersectionPosition(intersection).latitude()));
+    }
+    segment_index.cos_lat = cos(kDegreeToRadian * (min_lat + max_lat) / 2);
+
+    // Each segment's points: from, its curve points, to
+    segment_index.seg_point_start.resize(num_segments + 1);
+    for (int seg = 0; seg < num_segments; seg++) {
+        segment_index.seg_point_start[seg + 1] = segment_index.seg_point_start[seg] + getStreetSegmentInfo(seg).numCurvePoints + 2;
+    }
+    segment_index.seg_points.resize(segment_index.seg_point_start[num_segments]);
+    segment_index.seg_point_distance.resize(segment_index.seg_point_start[num_segments]);
+
+    #pragma omp parallel for
+    for (int seg = 0; seg < num_segments; seg++) {
+        StreetSegmentInfo seg_info = getStreetSegmentInfo(seg);
+        int start = segment_index.seg_point_start[seg];
+
+        segment_index.seg_points[start] = toMeters(getIntersectionPosition(seg_info.from));
+        for (int curve_point = 0; curve_point < seg_info.numCurvePoints; curve_point++) {
+            segment_index.seg_points[start + 1 + curve_point] = toMeters(getStreetSegmentCurvePoint(curve_point, seg));
+        }
+        segment_index.seg_points[start + seg_info.numCurvePoints + 1] = toMeters(getIntersectionPosition(seg_info.to));
+
+        segment_index.seg_point_distance[start] = 0;
+        for (int point = start + 1; point < segment_index.seg_point_start[seg + 1]; point++) {
+            const MeterPoint& prev = segment_index.seg_points[point - 1];
+            const MeterPoint& cur = segment_index.seg_points[point];
+            segment_index.seg_point_distance[point] = segment_index.seg_point_distance[point - 1] + hypot(cur.x - prev.x, cur.y - prev.y);
+        }
+    }
+
+    if (segment_index.seg_points.empty()) {
+        return;
+    }
+
+    // Grid bounds
+    double max_x = segment_index.seg_points[0].x, max_y = segment_index.seg_points[0].y;
+    segment_index.min_x = max_x;
+    segment_index.min_y = max_y;
+    for (const MeterPoint& point : segment_index.seg_points) {
+        segment_index.min_x = std::min(segment_index.min_x, point.x);
+        segment_index.min_y = std::min(segment_index.min_y, point.y);
+        max_x = std::max(max_x, point.x);
+        max_y = std::max(max_y, point.y);
+    }
+    segment_index.num_cols = static_cast<int>((max_x - segment_index.min_x) / SNAP_CELL_SIZE) + 1;
+    segment_index.num_rows = static_cast<int>((max_y - segment_index.min_y) / SNAP_CELL_SIZE) + 1;
+
+    // (cell, segment) pairs covering the bounding box of every polyline piece
+    std::vector<std::pair<int, StreetSegmentIdx>> cell_pairs;
+    for (int seg = 0; seg < num_segments; seg++) {
+        std::vector<int> cells;
+
+        for (int point = segment_index.seg_point_start[seg] + 1; point < segment_index.seg_point_start[seg + 1]; point++) {
+            const MeterPoint& prev = segment_index.seg_points[point - 1];
+            const MeterPoint& cur = segment_index.seg_points[point];
+
+            for (int row = cellRow(std::min(prev.y, cur.y)); row <= cellRow(std::max(prev.y, cur.y)); row++) {
+                for (int col = cellCol(std::min(prev.x, cur.x)); col <= cellCol(std::max(prev.x, cur.x)); col++) {
+                    cells.push_back(row * segment_index.num_cols + col);
+                }
+            }
+        }
+
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+        for (int cell : cells) {
+            cell_pairs.push_back({cell, seg});
+        }
+    }
+    std::sort(cell_pairs.begin(), cell_pairs.end());
+
+    segment_index.cell_start.assign(segment_index.num_cols * segment_index.num_rows + 1, 0);
+    segment_index.cell_segments.resize(cell_pairs.size());
+    for (size_t pair = 0; pair < cell_pairs.size(); pair++) {
+        segment_index.cell_start[cell_pairs[pair].first + 1]++;
+        segment_index.cell_segments[pair] = cell_pairs[pair].second;
+    }
+    for (size_t cell = 1; cell < segment_index.cell_start.size(); cell++) {
+        segment_index.cell_start[cell] += segment_index.cell_start[cell - 1];
+    }
+}
+
+void clearSegmentSpatialIndex() {
+    segment_index = SegmentSpatialIndex();
+}
+
+// Updates best if some point of seg is closer to the query. best_along is the distance
+// along the segment of that point, in meters
+void snapToSegment(MeterPoint query, StreetSegmentIdx seg, SnappedPoint& best, double& best_along) {
+    for (int point = segment_index.seg_point_start[seg] + 1; point < segment_index.seg_point_start[seg + 1]; point++) {
+        const MeterPoint& prev = segment_index.seg_points[point - 1];
+        const MeterPoint& cur = segment_index.seg_points[point];
+
+        // Closest point of the piece prev->cur
+        double dx = cur.x - prev.x, dy = cur.y - prev.y;
+        double piece_length_sq = dx * dx + dy * dy;
+        double t = 0;
+        if (piece_length_sq > 0) {
+            t = std::clamp(((query.x - prev.x) * dx + (query.y - prev.y) * dy) / piece_length_sq, 0.0, 1.0);
+        }
+
+        MeterPoint closest = {prev.x + t * dx, prev.y + t * dy};
+        double distance = hypot(query.x - closest.x, query.y - closest.y);
+
+        if (distance < best.distance) {
+            best.segment = seg;
+            best.distance = distance;
+            best.position = fromMeters(closest);
+            // Exact at the to end, so a position on an intersection gets a fraction of exactly 1
+            best_along = (t == 1) ? segment_index.seg_point_distance[point] : segment_index.seg_point_distance[point - 1] + t * sqrt(piece_length_sq);
+        }
+    }
+}
+
+// Searches rings of cells around the query until no unvisited cell can hold anything closer
+SnappedPoint snapToRoad(LatLon position, TravelProfile profile) {
+    SnappedPoint best;
+    best.position = position;
+
+    if (segment_index.cell_start.empty()) {
+        return best;
+    }
+
+    const ProfileGraph& graph = get_profile_graph(profile);
+    MeterPoint query = toMeters(position);
+    double best_along = 0;
+
+    // Grid cell nearest the query. For a query off the grid, a cell ring cells from it is still
+    // at least ring cells from the query, so the rings can stop as early
+    int query_col = cellCol(query.x);
+    int query_row = cellRow(query.y);
+
+    // Distance in cells to the furthest grid cell
+    int max_ring = std::max({query_col, segment_index.num_cols - 1 - query_col,
+                             query_row, segment_index.num_rows - 1 - query_row});
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+
+        // Anything in this ring or further is at least (ring - 1) cells away
+        if (best.distance <= (ring - 1) * SNAP_CELL_SIZE) {
+            break;
+        }
+
+        for (int row = query_row - ring; row <= query_row + ring; row++) {
+            if (row < 0 || row >= segment_index.num_rows) {
+                continue;
+            }
+
+            // Only the ring's border cells, the inside was already searched
+            int col_step = (row == query_row - ring || row == query_row + ring) ? 1 : std::max(1, 2 * ring);
+            for (int col = query_col - ring; col <= query_col + ring; col += col_step) {
+                if (col < 0 || col >= segment_index.num_cols) {
+                    continue;
+                }
+
+                int cell = row * segment_index.num_cols + col;
+                for (int idx = segment_index.cell_start[cell]; idx < segment_index.cell_start[cell + 1]; idx++) {
+                    StreetSegmentIdx seg = segment_index.cell_segments[idx];
+
+                    // Skip segments this profile can't use in either direction
+                    if (graph.forward_time[seg] == NO_ACCESS && graph.backward_time[seg] == NO_ACCESS) {
+                        continue;
+                    }
+
+                    snapToSegment(query, seg, best, best_along);
+                }
+            }
+        }
+    }
+
+    if (best.segment != -1) {
+        double seg_length = segment_index.seg_point_distance[segment_index.seg_point_start[best.segment + 1] - 1];
+        best.fraction = (seg_length > 0) ? best_along / seg_length : 0;
+    }
+
+    return best;
+}
+
+std::vector<SnappedPoint> snapToRoad(const std::vector<LatLon>& positions, TravelProfile profile) {
+    std::vector<SnappedPoint> snapped(positions.size());
+
+    // Queries only read the index, so they can run in parallel
+    #pragma omp parallel for
+    for (size_t idx = 0; idx < positions.size(); idx++) {
+        snapped[idx] = snapToRoad(positions[idx], profile);
+    }
+
+    return snapped;
+}
+
+// Snaps both positions, then searches from the ends of the start segment the profile can leave
+// through towards the ends of the end segment it can arrive through
+PositionPath findPathBetweenPositions(const double turn_penalty, const std::pair<LatLon, LatLon> positions, TravelProfile profile) {
+    PositionPath result;
+    result.start = snapToRoad(positions.first, profile);
+    result.end = snapToRoad(positions.second, profile);
+
+    StreetSegmentIdx start_seg = result.start.segment;
+    StreetSegmentIdx end_seg = result.end.segment;
+    if (start_seg == -1 || end_seg == -1) {
+        return result;
+    }
+
+    const ProfileGraph& graph = get_profile_graph(profile);
+    double total_time = DBL_MAX;
+
+    // Both on the same segment, in a direction it can be travelled
+    if (start_seg == end_seg) {
+        if (result.end.fraction >= result.start.fraction && graph.forward_time[start_seg] != NO_ACCESS) {
+            total_time = (result.end.fraction - result.start.fraction) * graph.forward_time[start_seg];
+        }
+        else if (result.end.fraction <= result.start.fraction && graph.backward_time[start_seg] != NO_ACCESS) {
+            total_time = (result.start.fraction - result.end.fraction) * graph.backward_time[start_seg];
+        }
+    }
+    double direct_time = total_time;
+
+    // Leave the start position through either end of its segment. A position right at an
+    // intersection starts from it directly, whatever the segment's direction
+    std::vector<WaveElem> seeds;
+    if (result.start.fraction == 1) {
+        seeds.push_back(WaveElem(get_street_seg_to(start_seg), NO_EDGE, 0, 0));
+    }
+    else if (graph.forward_time[start_seg] != NO_ACCESS) {
+        seeds.push_back(WaveElem(get_street_seg_to(start_seg), start_seg, (1 - result.start.fraction) * graph.forward_time[start_seg], 0));
+    }
+    if (result.start.fraction == 0) {
+        seeds.push_back(WaveElem(get_street_seg_from(start_seg), NO_EDGE, 0, 0));
+    }
+    else if (graph.backward_time[start_seg] != NO_ACCESS) {
+        seeds.push_back(WaveElem(get_street_seg_from(start_seg), start_seg, result.start.fraction * graph.backward_time[start_seg], 0));
+    }
+
+    // Arrive at the end position through either end of its segment, or directly if it is
+    // right at an intersection
+    std::vector<SearchTarget> targets;
+    if (result.end.fraction == 0) {
+        targets.push_back({get_street_seg_from(end_seg), 0, NO_EDGE});
+    }
+    else if (graph.forward_time[end_seg] != NO_ACCESS) {
+        targets.push_back({get_street_seg_from(end_seg), result.end.fraction * graph.forward_time[end_seg], end_seg});
+    }
+    if (result.end.fraction == 1) {
+        targets.push_back({get_street_seg_to(end_seg), 0, NO_EDGE});
+    }
+    else if (graph.backward_time[end_seg] != NO_ACCESS) {
+        targets.push_back({get_street_seg_to(end_seg), (1 - result.end.fraction) * graph.backward_time[end_seg], end_seg});
+    }
+
+    // Skip the search when the component labels rule out every seed / target pair
+    bool may_reach = false;
+    for (const WaveElem& seed : seeds) {
+        for (const SearchTarget& end_target : targets) {
+            may_reach = may_reach || pathMayExist(seed.nodeID, end_target.nodeID, profile);
+        }
+    }
+
+    int target = -1;
+    if (may_reach) {
+        target = bfsPathFromSeeds(seeds, targets, result.end.position, turn_penalty, profile, total_time);
+    }
+
+    if (target != -1) {
+        // Starts with start_seg only if the route drives part of it, a seed right at an
+        // intersection leaves along the next segment
+        result.segments = bfsTraceBack(targets[target].nodeID, start_seg);
+
+        // Likewise end_seg, unless the end position is the target intersection itself
+        if (targets[target].finalEdge != NO_EDGE && (result.segments.empty() || result.segments.back() != end_seg)) {
+            result.segments.push_back(end_seg);
+        }
+        result.travel_time = total_time;
+    }
+    else if (direct_time != DBL_MAX) {
+        result.segments = {start_seg};
+        result.travel_time = direct_time;
+    }
+
+    return result;
+}
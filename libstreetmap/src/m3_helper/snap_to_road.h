@@ -0,0 +1,66 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Snaps arbitrary (lat, lon) positions to the nearest point on a
+ * street segment and routes between such positions, starting and finishing
+ * part way along a segment instead of at an intersection. Uses a uniform grid
+ * over every segment's polyline (ends and curve points), built once in loadMap.
+ */
+
+#ifndef SNAP_TO_ROAD_H
+#define SNAP_TO_ROAD_H
+
+#include <utility>
+#include <vector>
+#include <float.h>
+
+#include "StreetsDatabaseAPI.h"
+#include "travel_profiles.h"
+
+// Side length of a spatial index cell, in meters
+#define SNAP_CELL_SIZE 100.0
+
+// A position on a street segment
+struct SnappedPoint {
+
+   // Segment the position lies on, -1 if nothing could be snapped to
+   StreetSegmentIdx segment = -1;
+
+   // How far along the segment, 0 at its from end and 1 at its to end
+   double fraction = 0;
+
+   // The snapped position itself
+   LatLon position;
+
+   // Distance from the queried position to the snapped one, in meters
+   double distance = DBL_MAX;
+};
+
+// Route between two snapped positions. segments holds every segment the route drives any part
+// of, so it starts with start.segment / ends with end.segment only when the position isn't
+// right at the intersection the route leaves / arrives through
+struct PositionPath {
+   SnappedPoint start;
+   SnappedPoint end;
+   std::vector<StreetSegmentIdx> segments;
+
+   // Includes only the travelled parts of the first and last segments, DBL_MAX when no route exists
+   double travel_time = DBL_MAX;
+};
+
+// Build / free the segment spatial index
+void loadSegmentSpatialIndex();
+void clearSegmentSpatialIndex();
+
+// Nearest point on any segment the profile may travel on
+SnappedPoint snapToRoad(LatLon position, TravelProfile profile = DRIVING);
+
+// Snaps every position, in parallel
+std::vector<SnappedPoint> snapToRoad(const std::vector<LatLon>& positions, TravelProfile profile = DRIVING);
+
+// Fastest route between two arbitrary positions, each snapped to the road first
+PositionPath findPathBetweenPositions(const double turn_penalty, const std::pair<LatLon, LatLon> positions, TravelProfile profile = DRIVING);
+
+#endif
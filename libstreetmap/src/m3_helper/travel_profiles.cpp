@@ -0,0 +1,300 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Builds the per-profile routing graphs declared in travel_profiles.h.
+ * Driving keeps the M3 weights (length / speed limit, one-way enforced). Walking
+ * opens every non-motorway segment in both directions at walking speed. Cycling
+ * is capped at cycling speed, stays off motorways and steps, and may walk its bike
+ * against one-ways on footways and pedestrian streets.
+ */
+
+#include "travel_profiles.h"
+#include "m1.h"
+#include "m1_globals.h"
+#include "OSMDatabaseAPI.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+// One graph per TravelProfile, and its reverse
+std::vector<ProfileGraph> profile_graphs;
+std::vector<ProfileGraph> reverse_profile_graphs;
+
+std::unordered_map<OSMID, std::string> loadWayHighwayTags();
+void labelStronglyConnectedComponents(ProfileGraph& graph);
+void labelWeaklyConnectedComponents(ProfileGraph& graph);
+bool isMotorwayRoadType(const std::string& road_type);
+bool isFootRoadType(const std::string& road_type);
+
+// Motorways and trunk roads, closed to walking and cycling
+bool isMotorwayRoadType(const std::string& road_type) {
+    return road_type == "motorway" || road_type == "motorway_link" ||
+           road_type == "trunk" || road_type == "trunk_link";
+}
+
+// Paths meant for pedestrians, where a cyclist walks the bike
+bool isFootRoadType(const std::string& road_type) {
+    return road_type == "footway" || road_type == "pedestrian" || road_type == "path" ||
+           road_type == "corridor" || road_type == "bridleway";
+}
+
+// Builds every profile's travel times, fastest speed and component labels
+void loadTravelProfiles() {
+    int num_segments = getNumStreetSegments();
+    std::unordered_map<OSMID, std::string> highway_tags = loadWayHighwayTags();
+
+    profile_graphs.assign(NUM_TRAVEL_PROFILES, ProfileGraph());
+
+    ProfileGraph& driving = profile_graphs[DRIVING];
+    ProfileGraph& walking = profile_graphs[WALKING];
+    ProfileGraph& cycling = profile_graphs[CYCLING];
+
+    for (ProfileGraph& graph : profile_graphs) {
+        graph.forward_time.resize(num_segments);
+        graph.backward_time.resize(num_segments);
+    }
+
+    driving.max_speed = get_max_speed();
+    walking.max_speed = WALKING_SPEED;
+
+    #pragma omp parallel for
+    for (int seg = 0; seg < num_segments; seg++) {
+        StreetSegmentInfo seg_info = getStreetSegmentInfo(seg);
+        double length = findStreetSegmentLength(seg);
+
+        auto tag_it = highway_tags.find(seg_info.wayOSMID);
+        std::string road_type = (tag_it != highway_tags.end()) ? tag_it->second : "";
+
+        // Driving: same weights as M3
+        driving.forward_time[seg] = findStreetSegmentTravelTime(seg);
+        driving.backward_time[seg] = seg_info.oneWay ? NO_ACCESS : driving.forward_time[seg];
+
+        // Walking: anything but motorways, both directions
+        if (isMotorwayRoadType(road_type)) {
+            walking.forward_time[seg] = walking.backward_time[seg] = NO_ACCESS;
+        }
+        else {
+            walking.forward_time[seg] = walking.backward_time[seg] = length / WALKING_SPEED;
+        }
+
+        // Cycling: no motorways or steps, walk the bike on foot paths
+        if (isMotorwayRoadType(road_type) || road_type == "steps") {
+            cycling.forward_time[seg] = cycling.backward_time[seg] = NO_ACCESS;
+        }
+        else if (isFootRoadType(road_type)) {
+            cycling.forward_time[seg] = cycling.backward_time[seg] = length / WALKING_SPEED;
+        }
+        else {
+            double speed = std::min(CYCLING_SPEED, static_cast<double>(seg_info.speedLimit));
+            cycling.forward_time[seg] = length / speed;
+            cycling.backward_time[seg] = seg_info.oneWay ? NO_ACCESS : cycling.forward_time[seg];
+        }
+    }
+
+    // Cyclists never go faster than their speed cap or the fastest speed limit
+    cycling.max_speed = std::min(CYCLING_SPEED, static_cast<double>(get_max_speed()));
+
+    // Components are independent per profile
+    #pragma omp parallel for
+    for (int profile = 0; profile < NUM_TRAVEL_PROFILES; profile++) {
+        labelStronglyConnectedComponents(profile_graphs[profile]);
+        labelWeaklyConnectedComponents(profile_graphs[profile]);
+    }
+
+    // Reversing a graph just swaps which direction of each segment is which
+    reverse_profile_graphs.assign(NUM_TRAVEL_PROFILES, ProfileGraph());
+    for (int profile = 0; profile < NUM_TRAVEL_PROFILES; profile++) {
+        reverse_profile_graphs[profile].forward_time = profile_graphs[profile].backward_time;
+        reverse_profile_graphs[profile].backward_time = profile_graphs[profile].forward_time;
+        reverse_profile_graphs[profile].max_speed = profile_graphs[profile].max_speed;
+    }
+}
+
+void clearTravelProfiles() {
+    profile_graphs.clear();
+    reverse_profile_graphs.clear();
+}
+
+const ProfileGraph& get_profile_graph(TravelProfile profile) {
+    return profile_graphs[profile];
+}
+
+const ProfileGraph& get_reverse_profile_graph(TravelProfile profile) {
+    return reverse_profile_graphs[profile];
+}
+
+int get_intersection_component(IntersectionIdx intersection_id, TravelProfile profile) {
+    return profile_graphs[profile].component[intersection_id];
+}
+
+// Tarjan numbers the components in reverse topological order (every component is closed
+// before any component that leads into it), so a path src -> dest needs a lower or equal label at dest
+bool pathMayExist(IntersectionIdx src, IntersectionIdx dest, TravelProfile profile) {
+    const ProfileGraph& graph = profile_graphs[profile];
+
+    return graph.weak_component[src] == graph.weak_component[dest] &&
+           graph.component[dest] <= graph.component[src];
+}
+
+double findStreetSegmentTravelTime(StreetSegmentIdx street_segment_id, TravelProfile profile) {
+    const ProfileGraph& graph = profile_graphs[profile];
+
+    if (graph.forward_time[street_segment_id] != NO_ACCESS) {
+        return graph.forward_time[street_segment_id];
+    }
+    return graph.backward_time[street_segment_id];
+}
+
+// Maps the OSMID of every way to its "highway" tag (road type), read straight from the
+// layer 1 API so this doesn't wait on OSMDatabaseAPIMembers
+std::unordered_map<OSMID, std::string> loadWayHighwayTags() {
+    std::unordered_map<OSMID, std::string> highway_tags;
+
+    for (int idx = 0; idx < getNumberOfWays(); idx++) {
+        const OSMWay* cur_way = getWayByIndex(idx);
+
+        for (int cur_tag = 0; cur_tag < getTagCount(cur_way); cur_tag++) {
+            std::pair<std::string, std::string> tag = getTagPair(cur_way, cur_tag);
+
+            if (tag.first == "highway") {
+                highway_tags[cur_way->id()] = tag.second;
+                break;
+            }
+        }
+    }
+
+    return highway_tags;
+}
+
+// Labels every intersection with the strongly connected component it belongs to on this
+// profile's graph. Uses an iterative version of Tarjan's algorithm since large maps overflow
+// the call stack if done recursively.
+void labelStronglyConnectedComponents(ProfileGraph& graph) {
+    int num_intersections = getNumIntersections();
+
+    graph.component.assign(num_intersections, -1);
+
+    // Tarjan discovery index and low-link of each intersection
+    std::vector<int> discovery(num_intersections, -1);
+    std::vector<int> low_link(num_intersections, 0);
+    std::vector<bool> on_stack(num_intersections, false);
+
+    // Intersections of the components still being built
+    std::vector<IntersectionIdx> component_stack;
+
+    // Simulated recursion: (intersection, next street segment to look at)
+    std::vector<std::pair<IntersectionIdx, int>> call_stack;
+
+    int next_discovery = 0;
+    int num_components = 0;
+
+    for (IntersectionIdx root = 0; root < num_intersections; root++) {
+        if (discovery[root] != -1) {
+            continue;
+        }
+
+        discovery[root] = low_link[root] = next_discovery++;
+        component_stack.push_back(root);
+        on_stack[root] = true;
+        call_stack.push_back({root, 0});
+
+        while (!call_stack.empty()) {
+            IntersectionIdx node = call_stack.back().first;
+            int seg_pos = call_stack.back().second;
+
+            // Visit the next street segment leaving this intersection
+            if (seg_pos < get_intersection_street_segments(node).size()) {
+                call_stack.back().second++;
+
+                StreetSegmentIdx seg = get_intersection_street_segments(node)[seg_pos];
+                IntersectionIdx next_node;
+
+                // Only follow directions this profile may use
+                if (get_street_seg_from(seg) == node && graph.forward_time[seg] != NO_ACCESS) {
+                    next_node = get_street_seg_to(seg);
+                }
+                else if (get_street_seg_to(seg) == node && graph.backward_time[seg] != NO_ACCESS) {
+                    next_node = get_street_seg_from(seg);
+                }
+                else {
+                    continue;
+                }
+
+                if (discovery[next_node] == -1) {
+                    discovery[next_node] = low_link[next_node] = next_discovery++;
+                    component_stack.push_back(next_node);
+                    on_stack[next_node] = true;
+                    call_stack.push_back({next_node, 0});
+                }
+                else if (on_stack[next_node]) {
+                    low_link[node] = std::min(low_link[node], discovery[next_node]);
+                }
+            }
+
+            // All segments visited, close the component if this intersection is its root
+            else {
+                if (low_link[node] == discovery[node]) {
+                    IntersectionIdx member;
+                    do {
+                        member = component_stack.back();
+                        component_stack.pop_back();
+                        on_stack[member] = false;
+                        graph.component[member] = num_components;
+                    } while (member != node);
+
+                    num_components++;
+                }
+
+                call_stack.pop_back();
+
+                // Propagate the low-link back to the caller
+                if (!call_stack.empty()) {
+                    IntersectionIdx parent = call_stack.back().first;
+                    low_link[parent] = std::min(low_link[parent], low_link[node]);
+                }
+            }
+        }
+    }
+}
+
+// Labels every intersection with its connected component when segment directions are ignored
+// (a segment only counts if the profile may use it one way or the other)
+void labelWeaklyConnectedComponents(ProfileGraph& graph) {
+    int num_intersections = getNumIntersections();
+
+    graph.weak_component.assign(num_intersections, -1);
+
+    std::vector<IntersectionIdx> to_visit;
+    int num_components = 0;
+
+    for (IntersectionIdx root = 0; root < num_intersections; root++) {
+        if (graph.weak_component[root] != -1) {
+            continue;
+        }
+
+        graph.weak_component[root] = num_components;
+        to_visit.push_back(root);
+
+        while (!to_visit.empty()) {
+            IntersectionIdx node = to_visit.back();
+            to_visit.pop_back();
+
+            for (StreetSegmentIdx seg : get_intersection_street_segments(node)) {
+                if (graph.forward_time[seg] == NO_ACCESS && graph.backward_time[seg] == NO_ACCESS) {
+                    continue;
+                }
+
+                IntersectionIdx next_node = (get_street_seg_from(seg) == node) ? get_street_seg_to(seg) : get_street_seg_from(seg);
+                if (graph.weak_component[next_node] == -1) {
+                    graph.weak_component[next_node] = num_components;
+                    to_visit.push_back(next_node);
+                }
+            }
+        }
+
+        num_components++;
+    }
+}
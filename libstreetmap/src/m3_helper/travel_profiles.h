@@ -0,0 +1,71 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Per-profile routing graphs (driving, walking, cycling). All profiles
+ * share the street segment topology; each one only owns its directional travel
+ * times, its fastest speed (for the A* heuristic) and its strongly connected
+ * component labels. Built once in loadMap.
+ */
+
+#ifndef TRAVEL_PROFILES_H
+#define TRAVEL_PROFILES_H
+
+#include <vector>
+
+#include "StreetsDatabaseAPI.h"
+
+// Travel time marking a street segment direction the profile may not use
+#define NO_ACCESS -1.0
+
+// Assumed travel speeds in m/s
+#define WALKING_SPEED 1.4
+#define CYCLING_SPEED 5.0
+
+// Travel modes the router supports
+enum TravelProfile {
+   DRIVING = 0,
+   WALKING,
+   CYCLING,
+   NUM_TRAVEL_PROFILES
+};
+
+// Weights and access rules of one travel mode over the shared street topology
+struct ProfileGraph {
+
+   // Travel time of each segment when going from->to and to->from, NO_ACCESS if not allowed
+   std::vector<double> forward_time;
+   std::vector<double> backward_time;
+
+   // Fastest speed any segment can be travelled at, in m/s
+   double max_speed = 1;
+
+   // Strongly connected component of each intersection, two intersections can
+   // reach each other exactly when their labels match. Numbered in reverse
+   // topological order, so a path from a to b needs component[b] <= component[a]
+   std::vector<int> component;
+
+   // Connected component of each intersection ignoring direction, no path can
+   // exist between different labels
+   std::vector<int> weak_component;
+};
+
+// Build / free the graphs of every profile, needs the street and OSM databases loaded
+void loadTravelProfiles();
+void clearTravelProfiles();
+
+const ProfileGraph& get_profile_graph(TravelProfile profile);
+
+// The same graph with every segment direction flipped, so a search on it from an intersection
+// finds the paths leading to it. Only the travel times and max_speed are filled in
+const ProfileGraph& get_reverse_profile_graph(TravelProfile profile);
+int get_intersection_component(IntersectionIdx intersection_id, TravelProfile profile = DRIVING);
+
+// False only when the component labels prove there is no path from src to dest
+bool pathMayExist(IntersectionIdx src, IntersectionIdx dest, TravelProfile profile = DRIVING);
+
+// Travel time of a street segment for the given profile, in whichever direction is allowed
+double findStreetSegmentTravelTime(StreetSegmentIdx street_segment_id, TravelProfile profile);
+
+#endif
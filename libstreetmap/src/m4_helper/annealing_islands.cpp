@@ -0,0 +1,42 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Island model for the annealing runs, see annealing_islands.h
+ */
+
+#include <cmath>
+
+#include "annealing_islands.h"
+
+IslandExchange::IslandExchange(int num_islands)
+    : latest(num_islands), published(num_islands) {
+
+    for (std::atomic<const IslandElite*>& slot : latest) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+void IslandExchange::publish(int island, std::vector<PickDrop> solution, double cost) {
+    published[island].push_back(std::make_unique<IslandElite>(std::move(solution), cost));
+
+    // Release so whoever loads the pointer also sees the tour it points to
+    latest[island].store(published[island].back().get(), std::memory_order_release);
+}
+
+const IslandElite* IslandExchange::neighbour(int island) const {
+    return latest[(island + 1) % latest.size()].load(std::memory_order_acquire);
+}
+
+double islandTemperatureFloor(int island, int num_islands) {
+    if (island == 0) {
+        return MIN_TEMPERATURE;
+    }
+    if (num_islands <= 2) {
+        return ISLAND_COOLEST_FLOOR;
+    }
+
+    double rung = static_cast<double>(island - 1) / (num_islands - 2);
+    return ISLAND_COOLEST_FLOOR * std::pow(ISLAND_WARMEST_FLOOR / ISLAND_COOLEST_FLOOR, rung);
+}
@@ -0,0 +1,68 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Island model for the annealing runs. There is one run (island) per
+ * hardware thread, each cooling to its own floor on a temperature ladder: island 0
+ * anneals as a lone run would, the others stay warmer the further up the ladder
+ * they are. Every MIGRATION_PHASES phases an island publishes its best tour and
+ * takes over its warmer neighbour's (around a ring) if that one is better. The
+ * exchange is lock-free: a published tour is never changed again, and islands only
+ * swap the pointer to their latest one.
+ * Migration depends on how far the other islands have got, so unlike the rest of
+ * the solver the same seed doesn't always give the same route once islands talk.
+ */
+
+#ifndef ANNEALING_ISLANDS_H
+#define ANNEALING_ISLANDS_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "m4_helper.h"
+
+// Temperature floors of the second and the last island, the ones in between spaced geometrically
+#define ISLAND_COOLEST_FLOOR 0.5
+#define ISLAND_WARMEST_FLOOR 20.0
+
+// Annealing phases between migrations
+#define MIGRATION_PHASES 2
+
+// A tour an island published, never changed once published
+struct IslandElite {
+    std::vector<PickDrop> solution;
+    double cost;
+
+    IslandElite(std::vector<PickDrop> elite_solution, double elite_cost)
+        : solution(std::move(elite_solution)), cost(elite_cost) {}
+};
+
+// Latest best of every island
+class IslandExchange {
+public:
+    explicit IslandExchange(int num_islands);
+
+    int size() const {
+        return static_cast<int>(latest.size());
+    }
+
+    // Makes the solution the island's latest best, only ever called by that island
+    void publish(int island, std::vector<PickDrop> solution, double cost);
+
+    // Latest best of the next island around the ring, nullptr if it hasn't published yet
+    const IslandElite* neighbour(int island) const;
+
+private:
+    std::vector<std::atomic<const IslandElite*>> latest;
+
+    // Every tour each island published. Another island may still be copying an old one,
+    // so they are only freed with the exchange
+    std::vector<std::vector<std::unique_ptr<IslandElite>>> published;
+};
+
+// Lowest temperature the island's annealing cools to
+double islandTemperatureFloor(int island, int num_islands);
+
+#endif
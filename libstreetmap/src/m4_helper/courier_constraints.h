@@ -0,0 +1,46 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Optional item weights, truck capacity and time windows of a courier
+ * problem. An item is picked up on the truck's first stop at its pick up and
+ * dropped off on the first stop at its drop off after that. Times are seconds
+ * after the truck reaches its first stop (it can leave the depot whenever it
+ * needs to), and a truck that arrives before a window opens waits for it.
+ */
+
+#ifndef COURIER_CONSTRAINTS_H
+#define COURIER_CONSTRAINTS_H
+
+#include <float.h>
+#include <vector>
+
+// When a pick up or drop off may be made
+struct TimeWindow {
+    double open = 0;
+    double close = DBL_MAX;
+};
+
+// Optional extras of one delivery
+struct DeliveryLimits {
+    double item_weight = 0;
+    TimeWindow pick_up;
+    TimeWindow drop_off;
+};
+
+// Optional capacity and time window constraints, none by default
+struct CourierConstraints {
+
+    // Most weight the truck can carry at once, 0 for no limit
+    double truck_capacity = 0;
+
+    // One entry per delivery in the same order, or empty for no weights or time windows
+    std::vector<DeliveryLimits> deliveries;
+
+    bool empty() const {
+        return truck_capacity <= 0 && deliveries.empty();
+    }
+};
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Multi-vehicle courier routing, see courier_fleet.h
+ */
+
+#include <algorithm>
+#include <float.h>
+#include <numeric>
+
+#include "courier_fleet.h"
+
+std::vector<std::vector<CourierSubPath>> travelingCourierFleet(const float turn_penalty,
+                                                              const std::vector<DeliveryInf>& deliveries,
+                                                              const std::vector<IntersectionIdx>& all_depots,
+                                                              const FleetOptions& fleet,
+                                                              const CourierOptions& options) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // Not enough trucks, or not enough room on them
+    int num_deliveries = static_cast<int>(deliveries.size());
+    if (fleet.num_vehicles < 1 ||
+        (fleet.max_deliveries > 0 && static_cast<long>(fleet.num_vehicles) * fleet.max_deliveries < num_deliveries)) {
+        return {};
+    }
+
+    std::vector<IntersectionIdx> depots = reachable_depots(deliveries, all_depots);
+    if (depots.empty()) {
+        return {};
+    }
+
+    const CourierMatrix matrix = computeCourierMatrix(deliveries, depots, turn_penalty);
+    if (options.stats != nullptr) {
+        options.stats->precompute_time = matrix.build_time;
+    }
+
+    const DepotTable depot_table(matrix, depots);
+
+    std::vector<std::vector<int>> groups = splitDeliveries(deliveries, matrix, depot_table, fleet);
+
+    // Every truck gets its own seed and its deliveries' share of the constraints, and no anytime
+    // reports since those describe a single route. Stats are summed over the trucks below
+    std::vector<std::vector<DeliveryInf>> vehicle_deliveries(fleet.num_vehicles);
+    std::vector<CourierOptions> vehicle_options(fleet.num_vehicles, options);
+    for (int vehicle = 0; vehicle < fleet.num_vehicles; vehicle++) {
+        vehicle_options[vehicle].seed = options.seed + vehicle;
+        vehicle_options[vehicle].on_improvement = nullptr;
+        vehicle_options[vehicle].stats = nullptr;
+        vehicle_options[vehicle].constraints.deliveries.clear();
+
+        for (int delivery : groups[vehicle]) {
+            vehicle_deliveries[vehicle].push_back(deliveries[delivery]);
+            if (!options.constraints.deliveries.empty()) {
+                vehicle_options[vehicle].constraints.deliveries.push_back(options.constraints.deliveries[delivery]);
+            }
+        }
+    }
+
+    std::vector<std::vector<CourierSubPath>> routes(fleet.num_vehicles);
+    long annealing_moves = 0;
+    double tour_cost = 0;
+    auto solve_start = std::chrono::high_resolution_clock::now();
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:annealing_moves, tour_cost)
+    for (int vehicle = 0; vehicle < fleet.num_vehicles; vehicle++) {
+        if (vehicle_deliveries[vehicle].empty()) {
+            continue;
+        }
+
+        CourierProgress progress(vehicle_options[vehicle], start_time);
+        PathOptions tour = solveCourierTour(vehicle_deliveries[vehicle], matrix, depot_table, progress);
+        routes[vehicle] = std::move(tour.path);
+        annealing_moves += progress.annealing_moves.load();
+        tour_cost += tour.travel_time;
+    }
+
+    // The trucks anneal side by side, so their time is the wall clock time of all of them
+    if (options.stats != nullptr) {
+        options.stats->annealing_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - solve_start).count();
+        options.stats->annealing_moves = annealing_moves;
+        options.stats->tour_cost = tour_cost;
+    }
+
+    // A truck with no route within its constraints would leave deliveries behind
+    for (int vehicle = 0; vehicle < fleet.num_vehicles; vehicle++) {
+        if (!vehicle_deliveries[vehicle].empty() && routes[vehicle].empty()) {
+            return {};
+        }
+    }
+
+    return routes;
+}
+
+std::vector<std::vector<int>> splitDeliveries(const std::vector<DeliveryInf>& deliveries,
+                                                      const CourierMatrix& matrix,
+                                                      const DepotTable& depot_table,
+                                                      const FleetOptions& fleet) {
+
+    int num_deliveries = static_cast<int>(deliveries.size());
+    int num_groups = std::min(fleet.num_vehicles, num_deliveries);
+
+    // First seed: the delivery furthest from every depot
+    std::vector<int> seeds;
+    double furthest = -1;
+    for (int delivery = 0; delivery < num_deliveries; delivery++) {
+        int pick_up = matrix.node_of.at(deliveries[delivery].pickUp);
+        int drop_off = matrix.node_of.at(deliveries[delivery].dropOff);
+
+        double nearest_depot = depot_table.cost(pick_up, drop_off);
+        if (nearest_depot > furthest) {
+            furthest = nearest_depot;
+            seeds.assign(1, delivery);
+        }
+    }
+
+    // Every next seed is the delivery furthest from all seeds so far
+    std::vector<double> seed_distance(num_deliveries, DBL_MAX);
+    while (static_cast<int>(seeds.size()) < num_groups) {
+        int best = -1;
+        for (int delivery = 0; delivery < num_deliveries; delivery++) {
+            seed_distance[delivery] = std::min(seed_distance[delivery], deliveryDistance(deliveries[delivery], deliveries[seeds.back()], matrix));
+            if (best == -1 || seed_distance[delivery] > seed_distance[best]) {
+                best = delivery;
+            }
+        }
+        seeds.push_back(best);
+    }
+
+    // Distance of every delivery to every seed, and how much it loses by not getting its closest
+    std::vector<std::vector<double>> distance(num_deliveries, std::vector<double>(num_groups));
+    std::vector<double> regret(num_deliveries, 0);
+
+    for (int delivery = 0; delivery < num_deliveries; delivery++) {
+        for (int group = 0; group < num_groups; group++) {
+            distance[delivery][group] = deliveryDistance(deliveries[delivery], deliveries[seeds[group]], matrix);
+        }
+
+        if (num_groups > 1) {
+            std::vector<double> sorted = distance[delivery];
+            std::partial_sort(sorted.begin(), sorted.begin() + 2, sorted.end());
+            regret[delivery] = sorted[1] - sorted[0];
+        }
+    }
+
+    // Seeds first so each starts its own group, then by regret
+    std::vector<int> assign_order(num_deliveries);
+    std::iota(assign_order.begin(), assign_order.end(), 0);
+    std::vector<bool> is_seed(num_deliveries, false);
+    for (int seed : seeds) {
+        is_seed[seed] = true;
+    }
+    std::stable_sort(assign_order.begin(), assign_order.end(), [&](int a, int b) {
+        if (is_seed[a] != is_seed[b]) {
+            return static_cast<bool>(is_seed[a]);
+        }
+        return regret[a] > regret[b];
+    });
+
+    std::vector<std::vector<int>> groups(fleet.num_vehicles);
+    for (int delivery : assign_order) {
+        int best_group = -1;
+        for (int group = 0; group < num_groups; group++) {
+            bool full = fleet.max_deliveries > 0 && static_cast<int>(groups[group].size()) >= fleet.max_deliveries;
+            if (!full && (best_group == -1 || distance[delivery][group] < distance[delivery][best_group])) {
+                best_group = group;
+            }
+        }
+        groups[best_group].push_back(delivery);
+    }
+
+    return groups;
+}
+
+double deliveryDistance(const DeliveryInf& a, const DeliveryInf& b, const CourierMatrix& matrix) {
+    int a_pick_up = matrix.node_of.at(a.pickUp);
+    int b_pick_up = matrix.node_of.at(b.pickUp);
+    int a_drop_off = matrix.node_of.at(a.dropOff);
+    int b_drop_off = matrix.node_of.at(b.dropOff);
+
+    return static_cast<double>(matrix.cost(a_pick_up, b_pick_up)) + matrix.cost(b_pick_up, a_pick_up)
+         + matrix.cost(a_drop_off, b_drop_off) + matrix.cost(b_drop_off, a_drop_off);
+}
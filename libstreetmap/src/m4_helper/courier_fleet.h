@@ -0,0 +1,49 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Multi-vehicle courier routing. The deliveries are split between
+ * the trucks (each delivery's pick up and drop off stay on the same truck), then
+ * every truck's tour is solved on its own with the single truck solver, all
+ * trucks in parallel and sharing one cost matrix.
+ */
+
+#ifndef COURIER_FLEET_H
+#define COURIER_FLEET_H
+
+#include <vector>
+
+#include "m4_helper.h"
+
+// Trucks available to travelingCourierFleet
+struct FleetOptions {
+
+    // Number of trucks, each starts and ends at the same depot (any depot)
+    int num_vehicles = 1;
+
+    // Most deliveries one truck can take, 0 for no limit (the weight a truck can carry at
+    // once is CourierOptions::constraints.truck_capacity)
+    int max_deliveries = 0;
+};
+
+// One route per truck, in the same format as travelingCourier (a truck with nothing to do
+// gets an empty route). Empty if no valid routes exist or the trucks can't take every delivery
+std::vector<std::vector<CourierSubPath>> travelingCourierFleet(const float turn_penalty,
+                                                              const std::vector<DeliveryInf>& deliveries,
+                                                              const std::vector<IntersectionIdx>& all_depots,
+                                                              const FleetOptions& fleet,
+                                                              const CourierOptions& options = CourierOptions());
+
+// Indices of each truck's deliveries: spread out seed deliveries, then each delivery joins its closest
+// seed with room, the deliveries with the most to lose from a worse choice going first.
+// The trucks must have room for every delivery
+std::vector<std::vector<int>> splitDeliveries(const std::vector<DeliveryInf>& deliveries,
+                                              const CourierMatrix& matrix,
+                                              const DepotTable& depot_table,
+                                              const FleetOptions& fleet);
+
+// Round trip time between two deliveries' pick ups plus between their drop offs
+double deliveryDistance(const DeliveryInf& a, const DeliveryInf& b, const CourierMatrix& matrix);
+
+#endif
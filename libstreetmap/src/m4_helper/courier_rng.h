@@ -0,0 +1,71 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Random numbers for the courier solver. Every greedy tour and every
+ * annealing run owns a xoshiro256** generator seeded from (seed, stream), so no
+ * state is shared between threads and a given seed always reproduces the same
+ * random choices however the work is split across threads.
+ */
+
+#ifndef COURIER_RNG_H
+#define COURIER_RNG_H
+
+#include <cstdint>
+#include <limits>
+
+// Seed travelingCourier uses when none is given
+#define COURIER_SEED 297
+
+struct CourierRng {
+    typedef uint64_t result_type;
+
+    uint64_t state[4];
+
+    // Independent stream number stream of the given seed
+    explicit CourierRng(uint64_t seed, uint64_t stream = 0) {
+        // splitmix64 spreads (seed, stream) over the whole state
+        uint64_t mix = seed ^ (stream * 0xD1B54A32D192ED03ull);
+        for (uint64_t& word : state) {
+            mix += 0x9E3779B97F4A7C15ull;
+            uint64_t z = mix;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<uint64_t>::max(); }
+
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    // Uniform in [0, bound), bound > 0
+    int below(int bound) {
+        return static_cast<int>(((*this)() >> 32) * static_cast<uint64_t>(bound) >> 32);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Exact courier tour for small instances, see exact_tour.h
+ */
+
+#include <algorithm>
+
+#include "exact_tour.h"
+
+// Delivery states, the base 3 digit of each delivery
+#define WAITING 0
+#define ON_TRUCK 1
+#define DROPPED_OFF 2
+
+ExactStops::ExactStops(const std::vector<DeliveryInf>& deliveries, const CourierMatrix& matrix) {
+    std::unordered_map<int, int> stop_of;
+
+    auto stopAt = [&](IntersectionIdx intersection) {
+        int node = matrix.node_of.at(intersection);
+        auto found = stop_of.find(node);
+        if (found != stop_of.end()) {
+            return found->second;
+        }
+
+        stop_of[node] = size();
+        nodes.push_back(node);
+        picked_up.emplace_back();
+        dropped_off.emplace_back();
+        return size() - 1;
+    };
+
+    for (int delivery = 0; delivery < static_cast<int>(deliveries.size()); delivery++) {
+        picked_up[stopAt(deliveries[delivery].pickUp)].push_back(delivery);
+        dropped_off[stopAt(deliveries[delivery].dropOff)].push_back(delivery);
+    }
+}
+
+std::vector<int> exactTransitions(const ExactStops& stops, int num_deliveries) {
+    std::vector<int> power(num_deliveries + 1, 1);
+    for (int delivery = 1; delivery <= num_deliveries; delivery++) {
+        power[delivery] = power[delivery - 1] * 3;
+    }
+
+    int num_stops = stops.size();
+    std::vector<int> transitions(static_cast<size_t>(power[num_deliveries]) * num_stops, -1);
+
+    for (int state = 0; state < power[num_deliveries]; state++) {
+        for (int stop = 0; stop < num_stops; stop++) {
+            int next = state;
+
+            // Pick ups first, so an item dropped off where it is picked up is done in one visit
+            for (int delivery : stops.picked_up[stop]) {
+                if (next / power[delivery] % 3 == WAITING) {
+                    next += power[delivery];
+                }
+            }
+            for (int delivery : stops.dropped_off[stop]) {
+                if (next / power[delivery] % 3 == ON_TRUCK) {
+                    next += power[delivery];
+                }
+            }
+
+            if (next != state) {
+                transitions[static_cast<size_t>(state) * num_stops + stop] = next;
+            }
+        }
+    }
+    return transitions;
+}
+
+// Every transition leads to a larger state, so states are settled in increasing order
+double exactDepotTour(const ExactStops& stops,
+                      const std::vector<int>& transitions,
+                      int depot_node,
+                      const CourierMatrix& matrix,
+                      std::vector<int>& tour_stops) {
+
+    int num_stops = stops.size();
+    int num_states = static_cast<int>(transitions.size() / num_stops);
+
+    // Every delivery DROPPED_OFF
+    int final_state = num_states - 1;
+
+    // Cheapest drive to each (state, stop), and the (state, stop) it came from
+    std::vector<double> cost(static_cast<size_t>(num_states) * num_stops, DBL_MAX);
+    std::vector<int> previous(cost.size(), -1);
+
+    // Out of the depot, only a pick up changes anything
+    for (int stop = 0; stop < num_stops; stop++) {
+        int next = transitions[stop];
+        if (next != -1) {
+            cost[static_cast<size_t>(next) * num_stops + stop] = matrix.cost(depot_node, stops.nodes[stop]);
+        }
+    }
+
+    for (int state = 1; state < final_state; state++) {
+        for (int from = 0; from < num_stops; from++) {
+            size_t at = static_cast<size_t>(state) * num_stops + from;
+            if (cost[at] == DBL_MAX) {
+                continue;
+            }
+
+            for (int to = 0; to < num_stops; to++) {
+                int next = transitions[static_cast<size_t>(state) * num_stops + to];
+                if (next == -1) {
+                    continue;
+                }
+
+                size_t reached = static_cast<size_t>(next) * num_stops + to;
+                double new_cost = cost[at] + matrix.cost(stops.nodes[from], stops.nodes[to]);
+                if (new_cost < cost[reached]) {
+                    cost[reached] = new_cost;
+                    previous[reached] = static_cast<int>(at);
+                }
+            }
+        }
+    }
+
+    // Back to the depot from wherever the last drop off is
+    double best_cost = DBL_MAX;
+    int best_end = -1;
+    for (int stop = 0; stop < num_stops; stop++) {
+        size_t at = static_cast<size_t>(final_state) * num_stops + stop;
+        if (cost[at] == DBL_MAX) {
+            continue;
+        }
+
+        double tour_cost = cost[at] + matrix.cost(stops.nodes[stop], depot_node);
+        if (tour_cost < best_cost) {
+            best_cost = tour_cost;
+            best_end = static_cast<int>(at);
+        }
+    }
+
+    tour_stops.clear();
+    for (int at = best_end; at != -1; at = previous[at]) {
+        tour_stops.push_back(at % num_stops);
+    }
+    std::reverse(tour_stops.begin(), tour_stops.end());
+
+    return best_cost;
+}
+
+PathOptions exact_courier_tour(const std::vector<DeliveryInf>& deliveries,
+                               const CourierMatrix& matrix,
+                               const DepotTable& depot_table) {
+
+    // Nothing to deliver or nowhere to start from, so no tour
+    if (deliveries.empty() || depot_table.depot_nodes.empty()) {
+        return PathOptions({}, {}, DBL_MAX);
+    }
+
+    int num_deliveries = static_cast<int>(deliveries.size());
+    ExactStops stops(deliveries, matrix);
+    std::vector<int> transitions = exactTransitions(stops, num_deliveries);
+
+    int num_depots = static_cast<int>(depot_table.depot_nodes.size());
+    std::vector<double> depot_cost(num_depots, DBL_MAX);
+    std::vector<std::vector<int>> depot_tour(num_depots);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int depot = 0; depot < num_depots; depot++) {
+        depot_cost[depot] = exactDepotTour(stops, transitions, depot_table.depot_nodes[depot], matrix, depot_tour[depot]);
+    }
+
+    int best_depot = static_cast<int>(std::min_element(depot_cost.begin(), depot_cost.end()) - depot_cost.begin());
+    if (depot_cost[best_depot] == DBL_MAX) {
+        return PathOptions({}, {}, DBL_MAX);
+    }
+
+    // Replay the tour to tell what happens at each stop
+    std::vector<PickDrop> solution;
+    std::vector<int> state(num_deliveries, WAITING);
+
+    for (int stop : depot_tour[best_depot]) {
+        bool picks_up = false;
+        bool drops_off = false;
+
+        for (int delivery : stops.picked_up[stop]) {
+            if (state[delivery] == WAITING) {
+                state[delivery] = ON_TRUCK;
+                picks_up = true;
+            }
+        }
+        for (int delivery : stops.dropped_off[stop]) {
+            if (state[delivery] == ON_TRUCK) {
+                state[delivery] = DROPPED_OFF;
+                drops_off = true;
+            }
+        }
+
+        int node = stops.nodes[stop];
+        solution.push_back({(picks_up && drops_off) ? 2 : (drops_off ? 1 : 0), matrix.intersections[node], node});
+    }
+
+    return PathOptions(PDDToCSP(solution, matrix, depot_table), solution, solution_cost(solution, matrix, depot_table));
+}
@@ -0,0 +1,60 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Exact courier tour for small instances, by dynamic programming over the cost
+ * matrix instead of greedy tours and annealing. The state is what has happened to every
+ * delivery (waiting, on the truck or dropped off, one base 3 digit each) and the stop the
+ * truck is at. Driving to a stop picks up everything waiting there and drops off everything
+ * on the truck for it, so the cheapest way to reach each state follows from states with
+ * smaller numbers only. A stop is driven to only if something happens there, but may be
+ * driven to more than once (e.g. to drop off an item picked up after its first visit).
+ * Every depot is its own problem, solved in parallel.
+ */
+
+#ifndef EXACT_TOUR_H
+#define EXACT_TOUR_H
+
+#include <vector>
+
+#include "m4_helper.h"
+
+// Most deliveries solved exactly. The states grow as 3^deliveries, 9 takes milliseconds
+#define EXACT_MAX_DELIVERIES 9
+
+// Pick up and drop off intersections of the deliveries, each once, and what happens at each
+struct ExactStops {
+
+    // Matrix node of each stop
+    std::vector<int> nodes;
+
+    // Deliveries picked up / dropped off at each stop
+    std::vector<std::vector<int>> picked_up;
+    std::vector<std::vector<int>> dropped_off;
+
+    ExactStops(const std::vector<DeliveryInf>& deliveries, const CourierMatrix& matrix);
+
+    int size() const {
+        return static_cast<int>(nodes.size());
+    }
+};
+
+// State after driving to each stop from each state (state * stops + stop), -1 where nothing
+// would happen there
+std::vector<int> exactTransitions(const ExactStops& stops, int num_deliveries);
+
+// Cheapest tour from and back to depot_node as a list of stops, and its cost
+double exactDepotTour(const ExactStops& stops,
+                      const std::vector<int>& transitions,
+                      int depot_node,
+                      const CourierMatrix& matrix,
+                      std::vector<int>& tour_stops);
+
+// Optimal tour over every depot, for at most EXACT_MAX_DELIVERIES deliveries and no capacity
+// or time windows. No stops and DBL_MAX when there is nothing to deliver or no depot
+PathOptions exact_courier_tour(const std::vector<DeliveryInf>& deliveries,
+                               const CourierMatrix& matrix,
+                               const DepotTable& depot_table);
+
+#endif
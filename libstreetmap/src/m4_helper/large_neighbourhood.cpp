@@ -0,0 +1,316 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Ruin and recreate over a courier tour, see large_neighbourhood.h
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+#include "large_neighbourhood.h"
+#include "annealing_islands.h"
+#include "local_search.h"
+
+int biasedIndex(int size, CourierRng& rng) {
+    return std::min(size - 1, static_cast<int>(std::pow(rng.uniform(), LNS_SELECTION_BIAS) * size));
+}
+
+double insertionCost(const AnnealingTour& tour, const std::vector<int>& route, int stop, int gap) {
+    int node = tour.stops[stop].node;
+    int size = static_cast<int>(route.size());
+
+    if (size == 0) {
+        return tour.depotCost(node, node);
+    }
+
+    int first = tour.stops[route.front()].node;
+    int last = tour.stops[route.back()].node;
+
+    if (gap == 0) {
+        return tour.legCost(node, first) + tour.depotCost(node, last) - tour.depotCost(first, last);
+    }
+    if (gap == size) {
+        return tour.legCost(last, node) + tour.depotCost(first, node) - tour.depotCost(first, last);
+    }
+
+    int before = tour.stops[route[gap - 1]].node;
+    int after = tour.stops[route[gap]].node;
+    return tour.legCost(before, node) + tour.legCost(node, after) - tour.legCost(before, after);
+}
+
+std::vector<std::vector<char>> precedenceClosure(const AnnealingTour& tour) {
+    int num_stops = static_cast<int>(tour.stops.size());
+    std::vector<std::vector<char>> follows(num_stops, std::vector<char>(num_stops, 0));
+
+    // Back to front, so everything a stop has to precede is complete before the stop itself
+    for (int pos = num_stops - 1; pos >= 0; pos--) {
+        int stop = tour.order[pos];
+
+        for (int next : tour.must_follow[stop]) {
+            follows[stop][next] = 1;
+            for (int later = 0; later < num_stops; later++) {
+                follows[stop][later] |= follows[next][later];
+            }
+        }
+    }
+    return follows;
+}
+
+double removalSaving(const AnnealingTour& tour, int pos) {
+    int last_pos = static_cast<int>(tour.order.size()) - 1;
+    if (last_pos == 0) {
+        return tour.cost;
+    }
+
+    int node = tour.nodeAt(pos);
+    int first = tour.nodeAt(0);
+    int last = tour.nodeAt(last_pos);
+
+    if (pos == 0) {
+        int next = tour.nodeAt(1);
+        return tour.depotCost(node, last) + tour.legCost(node, next) - tour.depotCost(next, last);
+    }
+    if (pos == last_pos) {
+        int previous = tour.nodeAt(last_pos - 1);
+        return tour.depotCost(first, node) + tour.legCost(previous, node) - tour.depotCost(first, previous);
+    }
+
+    int previous = tour.nodeAt(pos - 1);
+    int next = tour.nodeAt(pos + 1);
+    return tour.legCost(previous, node) + tour.legCost(node, next) - tour.legCost(previous, next);
+}
+
+std::vector<int> ruinStops(const AnnealingTour& tour, int num_removed, CourierRng& rng) {
+    int num_stops = static_cast<int>(tour.order.size());
+    num_removed = std::min(num_removed, num_stops);
+
+    std::vector<int> candidates(num_stops);
+    std::iota(candidates.begin(), candidates.end(), 0);
+    std::vector<int> removed;
+
+    switch (rng.below(NUM_RUIN_TYPES)) {
+        case RELATED_RUIN: {
+            // Each next stop is among the closest (both ways) to a random stop already taken out
+            int seed = rng.below(num_stops);
+            removed.push_back(seed);
+            candidates.erase(candidates.begin() + seed);
+
+            while (static_cast<int>(removed.size()) < num_removed) {
+                int related_to = tour.stops[removed[rng.below(static_cast<int>(removed.size()))]].node;
+                std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+                    int node_a = tour.stops[a].node;
+                    int node_b = tour.stops[b].node;
+                    return tour.legCost(related_to, node_a) + tour.legCost(node_a, related_to) <
+                           tour.legCost(related_to, node_b) + tour.legCost(node_b, related_to);
+                });
+
+                int pick = biasedIndex(static_cast<int>(candidates.size()), rng);
+                removed.push_back(candidates[pick]);
+                candidates.erase(candidates.begin() + pick);
+            }
+            break;
+        }
+
+        case WORST_RUIN: {
+            std::vector<double> saving(num_stops);
+            for (int pos = 0; pos < num_stops; pos++) {
+                saving[tour.order[pos]] = removalSaving(tour, pos);
+            }
+            std::sort(candidates.begin(), candidates.end(), [&](int a, int b) { return saving[a] > saving[b]; });
+
+            while (static_cast<int>(removed.size()) < num_removed) {
+                int pick = biasedIndex(static_cast<int>(candidates.size()), rng);
+                removed.push_back(candidates[pick]);
+                candidates.erase(candidates.begin() + pick);
+            }
+            break;
+        }
+
+        default: {
+            // Partial Fisher-Yates shuffle
+            for (int taken = 0; taken < num_removed; taken++) {
+                int pick = taken + rng.below(num_stops - taken);
+                std::swap(candidates[taken], candidates[pick]);
+                removed.push_back(candidates[taken]);
+            }
+            break;
+        }
+    }
+
+    return removed;
+}
+
+std::vector<int> recreateStops(const AnnealingTour& tour,
+                               const std::vector<std::vector<char>>& follows,
+                               const std::vector<int>& removed) {
+
+    std::vector<char> is_removed(tour.order.size(), 0);
+    for (int stop : removed) {
+        is_removed[stop] = 1;
+    }
+
+    std::vector<int> route;
+    for (int stop : tour.order) {
+        if (!is_removed[stop]) {
+            route.push_back(stop);
+        }
+    }
+
+    std::vector<int> remaining = removed;
+    while (!remaining.empty()) {
+        int best_index = -1;
+        int best_gap = -1;
+        double best_regret = -1;
+        double best_cost = DBL_MAX;
+
+        for (int index = 0; index < static_cast<int>(remaining.size()); index++) {
+            int stop = remaining[index];
+
+            // Strictly after everything placed it has to follow, and before everything it has to precede.
+            // The route keeps to the closure, so the window is never empty
+            int lo = 0;
+            int hi = static_cast<int>(route.size());
+            for (int pos = 0; pos < static_cast<int>(route.size()); pos++) {
+                if (follows[route[pos]][stop]) {
+                    lo = pos + 1;
+                }
+                else if (follows[stop][route[pos]] && pos < hi) {
+                    hi = pos;
+                }
+            }
+
+            // The LNS_REGRET cheapest gaps, cheapest first
+            double cheapest[LNS_REGRET];
+            int cheapest_gap = lo;
+            int num_options = 0;
+            for (int gap = lo; gap <= hi; gap++) {
+                double cost = insertionCost(tour, route, stop, gap);
+
+                int slot = std::min(num_options, LNS_REGRET - 1);
+                if (num_options == LNS_REGRET && cost >= cheapest[slot]) {
+                    continue;
+                }
+                while (slot > 0 && cheapest[slot - 1] > cost) {
+                    cheapest[slot] = cheapest[slot - 1];
+                    slot--;
+                }
+                cheapest[slot] = cost;
+                if (slot == 0) {
+                    cheapest_gap = gap;
+                }
+                num_options = std::min(num_options + 1, LNS_REGRET);
+            }
+
+            // A stop with fewer places to go than LNS_REGRET goes first, as it could soon have none good
+            double regret = (num_options < LNS_REGRET) ? DBL_MAX : 0;
+            for (int option = 1; option < num_options; option++) {
+                regret = std::min(DBL_MAX, regret + cheapest[option] - cheapest[0]);
+            }
+
+            if (regret > best_regret || (regret == best_regret && cheapest[0] < best_cost)) {
+                best_index = index;
+                best_gap = cheapest_gap;
+                best_regret = regret;
+                best_cost = cheapest[0];
+            }
+        }
+
+        route.insert(route.begin() + best_gap, remaining[best_index]);
+        remaining.erase(remaining.begin() + best_index);
+    }
+
+    return route;
+}
+
+// Ruin and recreate from the initial solution. The current tour moves to every recreated tour
+// that is better than it or close enough to the best; a new best is polished with local search
+// and reported. Every LNS_MIGRATION_ITERATIONS iterations the run trades best tours with its
+// neighbouring island. Stops when progress says so, or after LNS_CONVERGENCE_ITERATIONS
+// iterations without a new best
+PathOptions large_neighbourhood_search(const std::vector<PickDrop>& initial_solution,
+                                       const CourierMatrix& matrix,
+                                       const DepotTable& depot_table,
+                                       const ScheduleLimits& limits,
+                                       CourierRng& rng,
+                                       CourierProgress& progress,
+                                       IslandExchange& islands,
+                                       int island) {
+
+    // The tour is rebuilt over another island's stops when it migrates here
+    std::vector<PickDrop> stops = initial_solution;
+    std::unique_ptr<AnnealingTour> tour = std::make_unique<AnnealingTour>(stops, matrix, depot_table, limits);
+    std::vector<std::vector<char>> follows = precedenceClosure(*tour);
+    localSearch(*tour);
+
+    double best_cost = tour->cost;
+    std::vector<int> best_order = tour->order;
+    std::vector<int> current_order = tour->order;
+    long last_improvement = 0;
+    bool unpublished = true;
+
+    int num_stops = static_cast<int>(stops.size());
+    int max_removed = std::max(1, std::min(LNS_MAX_REMOVED, static_cast<int>(num_stops * LNS_MAX_REMOVED_FRACTION)));
+    int min_removed = std::min(LNS_MIN_REMOVED, max_removed);
+
+    long iteration;
+    for (iteration = 1; iteration - last_improvement <= LNS_CONVERGENCE_ITERATIONS && !progress.shouldStop(); iteration++) {
+        int num_removed = min_removed + rng.below(max_removed - min_removed + 1);
+        std::vector<int> new_order = recreateStops(*tour, follows, ruinStops(*tour, num_removed, rng));
+
+        // Insertion only looks at travel time, so a tour that breaks the limits is thrown away
+        if (tour->limits == nullptr || tour->meetsLimits(new_order)) {
+            tour->setOrder(new_order);
+
+            if (tour->cost < best_cost - IMPROVEMENT_EPSILON) {
+                localSearch(*tour);
+                best_cost = tour->cost;
+                best_order = tour->order;
+                last_improvement = iteration;
+                unpublished = true;
+                progress.report(tour->solution(best_order), matrix, depot_table);
+            }
+
+            if (tour->cost < best_cost * (1 + LNS_RECORD_DEVIATION)) {
+                current_order = tour->order;
+            }
+            else {
+                tour->setOrder(current_order);
+            }
+        }
+
+        if (iteration % LNS_MIGRATION_ITERATIONS == 0) {
+            if (unpublished) {
+                islands.publish(island, tour->solution(best_order), best_cost);
+                unpublished = false;
+            }
+
+            // A better neighbour replaces this island's tour, and counts as a new best here
+            const IslandElite* immigrant = islands.neighbour(island);
+            if (immigrant != nullptr && immigrant->cost < best_cost - IMPROVEMENT_EPSILON) {
+                stops = immigrant->solution;
+                tour = std::make_unique<AnnealingTour>(stops, matrix, depot_table, limits);
+                follows = precedenceClosure(*tour);
+
+                best_cost = tour->cost;
+                best_order = tour->order;
+                current_order = tour->order;
+                last_improvement = iteration;
+            }
+        }
+    }
+
+    // Price the result from scratch rather than trusting the running sums
+    std::vector<PickDrop> best_solution = tour->solution(best_order);
+
+    // Islands still running can take this tour over once this one is done
+    if (unpublished) {
+        islands.publish(island, best_solution, best_cost);
+    }
+
+    progress.annealing_moves.fetch_add(iteration, std::memory_order_relaxed);
+    return PathOptions(PDDToCSP(best_solution, matrix, depot_table), best_solution, solution_cost(best_solution, matrix, depot_table));
+}
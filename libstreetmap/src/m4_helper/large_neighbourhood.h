@@ -0,0 +1,84 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Large neighbourhood search (ruin and recreate), the alternative to
+ * simulated_annealing for long tours where single stop moves stall. Every
+ * iteration takes a group of stops out of the tour (at random, close together on
+ * the map, or the ones costing the most where they are) and puts them back one at
+ * a time with regret-k insertion: the stop inserted next is the one that would
+ * lose the most by not getting its best position, each at its cheapest position
+ * between the stops it has to follow and the ones it has to precede.
+ * A new tour is kept if it is better, or within LNS_RECORD_DEVIATION of the best
+ * so far. Runs are islands exactly like the annealing ones (see annealing_islands.h).
+ */
+
+#ifndef LARGE_NEIGHBOURHOOD_H
+#define LARGE_NEIGHBOURHOOD_H
+
+#include <vector>
+
+#include "m4_helper.h"
+#include "tour_moves.h"
+
+// Fewest and most stops taken out at once, and the most as a share of the tour
+#define LNS_MIN_REMOVED 4
+#define LNS_MAX_REMOVED 40
+#define LNS_MAX_REMOVED_FRACTION 0.3
+
+// Positions compared for each stop's regret (k in regret-k)
+#define LNS_REGRET 3
+
+// A worse tour is still taken if it is within this fraction of the best one
+#define LNS_RECORD_DEVIATION 0.005
+
+// Iterations without a new best after which a run has converged
+#define LNS_CONVERGENCE_ITERATIONS 20000
+
+// Iterations between migrations
+#define LNS_MIGRATION_ITERATIONS 256
+
+// How strongly related / costly removal prefers the most related / costly stops (1 = not at all)
+#define LNS_SELECTION_BIAS 4
+
+// Ways ruinStops picks the stops to take out
+enum RuinType {
+    RANDOM_RUIN = 0,  // Any stops
+    RELATED_RUIN,     // Stops close to ones already taken out
+    WORST_RUIN,       // Stops costing the most where they are
+    NUM_RUIN_TYPES
+};
+
+// follows[a][b] is 1 if stop a has to come before stop b, directly or through other stops.
+// The tour's order has to keep to its precedence
+std::vector<std::vector<char>> precedenceClosure(const AnnealingTour& tour);
+
+// Time saved by taking the stop at pos out of the tour
+double removalSaving(const AnnealingTour& tour, int pos);
+
+// Index into a list sorted best first, leaning towards the front the higher LNS_SELECTION_BIAS is
+int biasedIndex(int size, CourierRng& rng);
+
+// Cost of putting stop at gap of the partial route (before route[gap], gap == route size to append)
+double insertionCost(const AnnealingTour& tour, const std::vector<int>& route, int stop, int gap);
+
+// num_removed stops to take out of the tour
+std::vector<int> ruinStops(const AnnealingTour& tour, int num_removed, CourierRng& rng);
+
+// The tour's order with the removed stops taken out and put back by regret-k insertion
+std::vector<int> recreateStops(const AnnealingTour& tour,
+                               const std::vector<std::vector<char>>& follows,
+                               const std::vector<int>& removed);
+
+// Improves the tour with ruin and recreate, with the same contract as simulated_annealing
+PathOptions large_neighbourhood_search(const std::vector<PickDrop>& initial_solution,
+                                       const CourierMatrix& matrix,
+                                       const DepotTable& depot_table,
+                                       const ScheduleLimits& limits,
+                                       CourierRng& rng,
+                                       CourierProgress& progress,
+                                       IslandExchange& islands,
+                                       int island);
+
+#endif
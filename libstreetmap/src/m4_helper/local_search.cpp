@@ -0,0 +1,264 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Neighbour list local search between annealing phases, see local_search.h
+ */
+
+#include <algorithm>
+
+#include "local_search.h"
+
+bool localSearch(AnnealingTour& tour) {
+    double start_cost = tour.cost;
+
+    bool improved = true;
+    for (int pass = 0; improved && pass < LOCAL_SEARCH_MAX_PASSES; pass++) {
+        improved = twoOptPass(tour);
+        improved = orOptPass(tour) || improved;
+        improved = relocatePairsPass(tour) || improved;
+    }
+
+    return tour.cost < start_cost - IMPROVEMENT_EPSILON;
+}
+
+FeasibleWindow feasibleWindow(const AnnealingTour& tour, int lo, int hi, int ignore) {
+    FeasibleWindow window = {-1, static_cast<int>(tour.order.size())};
+
+    for (int pos = lo; pos <= hi; pos++) {
+        int stop = tour.order[pos];
+
+        for (int other : tour.must_precede[stop]) {
+            if (other != ignore && tour.position[other] < lo) {
+                window.after = std::max(window.after, tour.position[other]);
+            }
+        }
+        for (int other : tour.must_follow[stop]) {
+            if (other != ignore && tour.position[other] > hi) {
+                window.before = std::min(window.before, tour.position[other]);
+            }
+        }
+    }
+
+    return window;
+}
+
+// Reverses the stops between a stop and one of its neighbours further on, so the two become adjacent
+bool twoOptPass(AnnealingTour& tour) {
+    bool improved = false;
+    int num_stops = static_cast<int>(tour.order.size());
+
+    for (int pos = 0; pos < num_stops; pos++) {
+        for (int neighbour : tour.neighbours[tour.order[pos]]) {
+            int neighbour_pos = tour.position[neighbour];
+            if (neighbour_pos <= pos + 1) {
+                continue;
+            }
+
+            TourMove move(TourMove::REVERSE, pos + 1, neighbour_pos);
+            if (tour.isLegal(move) && tour.costChange(move) < -IMPROVEMENT_EPSILON && tour.meetsLimits(move)) {
+                tour.apply(move);
+                improved = true;
+                break;
+            }
+        }
+    }
+
+    return improved;
+}
+
+// Moves runs of 1..OR_OPT_MAX_LENGTH stops to just before a neighbour of their last stop
+bool orOptPass(AnnealingTour& tour) {
+    bool improved = false;
+    int num_stops = static_cast<int>(tour.order.size());
+
+    for (int length = 1; length <= OR_OPT_MAX_LENGTH && length < num_stops; length++) {
+        for (int start = 0; start + length <= num_stops; start++) {
+            int end = start + length - 1;
+            FeasibleWindow window = feasibleWindow(tour, start, end);
+
+            for (int neighbour : tour.neighbours[tour.order[end]]) {
+                int neighbour_pos = tour.position[neighbour];
+
+                // Later: the stops jumped over (end+1 .. neighbour_pos-1) can't include one that must follow
+                if (neighbour_pos > end + 1 && neighbour_pos <= window.before) {
+                    TourMove move(TourMove::SHIFT, start, neighbour_pos - length, length);
+                    if (tour.costChange(move) < -IMPROVEMENT_EPSILON && tour.meetsLimits(move)) {
+                        tour.apply(move);
+                        improved = true;
+                        break;
+                    }
+                }
+                // Earlier: the stops jumped over (neighbour_pos .. start-1) can't include one that must precede
+                else if (neighbour_pos < start && neighbour_pos > window.after) {
+                    TourMove move(TourMove::SHIFT, start, neighbour_pos, length);
+                    if (tour.costChange(move) < -IMPROVEMENT_EPSILON && tour.meetsLimits(move)) {
+                        tour.apply(move);
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    return improved;
+}
+
+// Takes out a pick up and one of its drop offs together, and puts each back before one of
+// its neighbours (the drop off may also go straight after the pick up, or at the very end)
+bool relocatePairsPass(AnnealingTour& tour) {
+    bool improved = false;
+    int num_stops = static_cast<int>(tour.order.size());
+    if (num_stops < 3) {
+        return false;
+    }
+
+    for (int pick_up = 0; pick_up < num_stops; pick_up++) {
+        for (size_t pair = 0; pair < tour.must_follow[pick_up].size(); pair++) {
+            int drop_off = tour.must_follow[pick_up][pair];
+
+            FeasibleWindow pick_up_window = feasibleWindow(tour, tour.position[pick_up], tour.position[pick_up], drop_off);
+            FeasibleWindow drop_off_window = feasibleWindow(tour, tour.position[drop_off], tour.position[drop_off], pick_up);
+
+            double best_change = -IMPROVEMENT_EPSILON;
+            int best_pick_up_before = -1;
+            int best_drop_off_before = -1;
+
+            for (int pick_up_before : tour.neighbours[pick_up]) {
+                int pick_up_pos = tour.position[pick_up_before];
+                if (pick_up_before == drop_off || pick_up_pos <= pick_up_window.after || pick_up_pos > pick_up_window.before) {
+                    continue;
+                }
+
+                std::vector<int> drop_off_anchors = tour.neighbours[drop_off];
+                drop_off_anchors.push_back(pick_up_before);
+                drop_off_anchors.push_back(END_OF_TOUR);
+
+                for (int drop_off_before : drop_off_anchors) {
+                    int drop_off_pos = (drop_off_before == END_OF_TOUR) ? num_stops : tour.position[drop_off_before];
+                    if (drop_off_before == pick_up || drop_off_pos < pick_up_pos ||
+                        drop_off_pos <= drop_off_window.after || drop_off_pos > drop_off_window.before) {
+                        continue;
+                    }
+
+                    double change = relocatePairChange(tour, pick_up, drop_off, pick_up_before, drop_off_before);
+                    if (change < best_change) {
+                        best_change = change;
+                        best_pick_up_before = pick_up_before;
+                        best_drop_off_before = drop_off_before;
+                    }
+                }
+            }
+
+            if (best_pick_up_before != -1 && relocatePair(tour, pick_up, drop_off, best_pick_up_before, best_drop_off_before)) {
+                improved = true;
+            }
+        }
+    }
+
+    return improved;
+}
+
+double relocatePairChange(const AnnealingTour& tour, int pick_up, int drop_off, int pick_up_before, int drop_off_before) {
+    int last = static_cast<int>(tour.order.size()) - 1;
+    int pick_up_pos = tour.position[pick_up];
+    int drop_off_pos = tour.position[drop_off];
+    int p = tour.stops[pick_up].node;
+    int d = tour.stops[drop_off].node;
+
+    // Node of the nearest stop strictly before / after pos once the pair is taken out, -1 if none
+    auto previousNode = [&](int pos) {
+        for (pos--; pos >= 0; pos--) {
+            if (pos != pick_up_pos && pos != drop_off_pos) {
+                return tour.nodeAt(pos);
+            }
+        }
+        return -1;
+    };
+    auto nextNode = [&](int pos) {
+        for (pos++; pos <= last; pos++) {
+            if (pos != pick_up_pos && pos != drop_off_pos) {
+                return tour.nodeAt(pos);
+            }
+        }
+        return -1;
+    };
+
+    // Leg cost, nothing when either end is missing
+    auto leg = [&](int from, int to) {
+        return (from == -1 || to == -1) ? 0.0 : tour.legCost(from, to);
+    };
+
+    double change = 0;
+
+    // Take the pair out
+    if (drop_off_pos == pick_up_pos + 1) {
+        int before = previousNode(pick_up_pos);
+        int after = nextNode(drop_off_pos);
+        change += leg(before, after) - leg(before, p) - leg(p, d) - leg(d, after);
+    }
+    else {
+        int before = previousNode(pick_up_pos);
+        int after = tour.nodeAt(pick_up_pos + 1);
+        change += leg(before, after) - leg(before, p) - leg(p, after);
+
+        before = tour.nodeAt(drop_off_pos - 1);
+        after = nextNode(drop_off_pos);
+        change += leg(before, after) - leg(before, d) - leg(d, after);
+    }
+
+    // Put them back
+    int pick_up_next = tour.stops[pick_up_before].node;
+    int pick_up_previous = previousNode(tour.position[pick_up_before]);
+
+    if (drop_off_before == pick_up_before) {
+        change += leg(pick_up_previous, p) + leg(p, d) + leg(d, pick_up_next) - leg(pick_up_previous, pick_up_next);
+    }
+    else {
+        change += leg(pick_up_previous, p) + leg(p, pick_up_next) - leg(pick_up_previous, pick_up_next);
+
+        int drop_off_next = (drop_off_before == END_OF_TOUR) ? -1 : tour.stops[drop_off_before].node;
+        int drop_off_previous = previousNode((drop_off_before == END_OF_TOUR) ? last + 1 : tour.position[drop_off_before]);
+        change += leg(drop_off_previous, d) + leg(d, drop_off_next) - leg(drop_off_previous, drop_off_next);
+    }
+
+    // Depot legs, if either end of the tour changes
+    int new_first = (pick_up_previous == -1) ? p : nextNode(-1);
+    int new_last = (drop_off_before == END_OF_TOUR) ? d : previousNode(last + 1);
+    if (new_first != tour.nodeAt(0) || new_last != tour.nodeAt(last)) {
+        change += tour.depotCost(new_first, new_last) - tour.depot_cost;
+    }
+
+    return change;
+}
+
+bool relocatePair(AnnealingTour& tour, int pick_up, int drop_off, int pick_up_before, int drop_off_before) {
+    std::vector<int> new_order;
+    new_order.reserve(tour.order.size());
+
+    for (int stop : tour.order) {
+        if (stop == pick_up || stop == drop_off) {
+            continue;
+        }
+        if (stop == pick_up_before) {
+            new_order.push_back(pick_up);
+        }
+        if (stop == drop_off_before) {
+            new_order.push_back(drop_off);
+        }
+        new_order.push_back(stop);
+    }
+
+    if (drop_off_before == END_OF_TOUR) {
+        new_order.push_back(drop_off);
+    }
+
+    if (!tour.meetsLimits(new_order)) {
+        return false;
+    }
+
+    tour.setOrder(new_order);
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Deterministic local search run on the best tour between annealing
+ * phases. Only moves that bring a stop next to one of its nearest neighbours are
+ * tried (2-opt, Or-opt of up to OR_OPT_MAX_LENGTH stops, and relocating a pick up
+ * together with its drop off), and insertion points outside a stop's precedence
+ * window are skipped before any pricing.
+ */
+
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include "tour_moves.h"
+
+// Longest run of stops an Or-opt move carries
+#define OR_OPT_MAX_LENGTH 3
+
+// Smallest saving that counts, so float noise can't make moves cycle
+#define IMPROVEMENT_EPSILON 1e-6
+
+// Upper bound on full passes over the tour
+#define LOCAL_SEARCH_MAX_PASSES 50
+
+// Stop to insert a drop off before when it should go at the very end of the tour
+#define END_OF_TOUR -1
+
+// Positions stops can go between without breaking pick up / drop off order: strictly after
+// after and strictly before before
+struct FeasibleWindow {
+    int after;
+    int before;
+};
+
+// Improves the tour until no move in the neighbour lists saves time. Returns whether it improved
+bool localSearch(AnnealingTour& tour);
+
+// One pass of each move type, returning whether anything was applied
+bool twoOptPass(AnnealingTour& tour);
+bool orOptPass(AnnealingTour& tour);
+bool relocatePairsPass(AnnealingTour& tour);
+
+// Window of the stops at positions lo..hi, ignoring constraints on the stop ignore (-1 for none)
+FeasibleWindow feasibleWindow(const AnnealingTour& tour, int lo, int hi, int ignore = -1);
+
+// Cost change of taking out pick_up and drop_off and putting pick_up right before stop
+// pick_up_before and drop_off right before drop_off_before (END_OF_TOUR to append it).
+// relocatePair leaves the tour alone and returns false if that breaks the capacity or a time window
+double relocatePairChange(const AnnealingTour& tour, int pick_up, int drop_off, int pick_up_before, int drop_off_before);
+bool relocatePair(AnnealingTour& tour, int pick_up, int drop_off, int pick_up_before, int drop_off_before);
+
+#endif
@@ -7,6 +7,41 @@
  */
 
 #include "m4_helper.h"
+#include "tour_moves.h"
+#include "local_search.h"
+#include "truck_schedule.h"
+#include "annealing_islands.h"
+#include "large_neighbourhood.h"
+#include "exact_tour.h"
+
+// A route exists only if every pick-up, drop-off and the chosen depot can reach each other,
+// i.e. they all share one strongly connected component of the street graph
+std::vector<IntersectionIdx> reachable_depots(const std::vector<DeliveryInf>& deliveries,
+                                              const std::vector<IntersectionIdx>& depots)
+{
+    // No deliveries, no route to make
+    if (deliveries.empty()) {
+        return {};
+    }
+
+    int component = get_intersection_component(deliveries[0].pickUp);
+
+    for (const DeliveryInf& delivery : deliveries) {
+        if (get_intersection_component(delivery.pickUp) != component || get_intersection_component(delivery.dropOff) != component) {
+            return {};
+        }
+    }
+
+    // Keep only the depots the truck can leave from and return to
+    std::vector<IntersectionIdx> usable_depots;
+    for (IntersectionIdx depot : depots) {
+        if (get_intersection_component(depot) == component) {
+            usable_depots.push_back(depot);
+        }
+    }
+
+    return usable_depots;
+}
 
 std::vector<IntersectionIdx> remove_duplicate_intersections(const std::vector<DeliveryInf>& deliveries,
                                                             const std::vector<IntersectionIdx>& depots) 
@@ -19,223 +54,642 @@ std::vector<IntersectionIdx> remove_duplicate_intersections(const std::vector<De
         all_intersections.push_back(delivery.dropOff);
     }
 
-    // get rid of duplicates
+    // get rid of duplicates (std::unique only drops adjacent ones)
+    std::sort(all_intersections.begin(), all_intersections.end());
     all_intersections.erase(std::unique(all_intersections.begin(), all_intersections.end()), all_intersections.end());
     return all_intersections; // from least to greatest
 }
 
-std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> fillPathMatrix(
-                                                                        const std::vector<IntersectionIdx>& interesting_intersections, // All unique intersections
-                                                                        const double turn_penalty) // Turn penalty for bfs
-{
-    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> all_interesting_paths;
+// Cost matrix over every pick up, drop off and depot. Each row is searched and written by one
+// thread: its costs straight into the matrix, its paths into a row of their own and their lengths
+// into the row's offset slots, so no thread ever waits on another
+CourierMatrix computeCourierMatrix(const std::vector<DeliveryInf>& deliveries,
+                                   const std::vector<IntersectionIdx>& depots,
+                                   const double turn_penalty) {
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    CourierMatrix matrix;
+    matrix.intersections = remove_duplicate_intersections(deliveries, depots);
+
+    size_t num_nodes = matrix.intersections.size();
+    for (size_t node = 0; node < num_nodes; node++) {
+        matrix.node_of[matrix.intersections[node]] = static_cast<int>(node);
+    }
+
+    std::vector<char> is_target(getNumIntersections(), 0);
+    for (IntersectionIdx intersection : matrix.intersections) {
+        is_target[intersection] = 1;
+    }
+
+    std::vector<char> is_stop(num_nodes, 0);
+    std::vector<int> pick_up_nodes;
+    for (const DeliveryInf& delivery : deliveries) {
+        is_stop[matrix.node_of.at(delivery.pickUp)] = 1;
+        is_stop[matrix.node_of.at(delivery.dropOff)] = 1;
+        pick_up_nodes.push_back(matrix.node_of.at(delivery.pickUp));
+    }
+    std::sort(pick_up_nodes.begin(), pick_up_nodes.end());
+    pick_up_nodes.erase(std::unique(pick_up_nodes.begin(), pick_up_nodes.end()), pick_up_nodes.end());
+
+    std::vector<int> depot_nodes;
+    for (size_t node = 0; node < num_nodes; node++) {
+        if (!is_stop[node]) {
+            depot_nodes.push_back(static_cast<int>(node));
+        }
+    }
+
+    // A depot's row is only ever driven to a pick up. With more depots than pick ups those legs take
+    // fewer searches backwards from the pick ups, so the depots get no row search of their own
+    bool depots_backwards = depot_nodes.size() > pick_up_nodes.size();
+
+    matrix.costs.resize(num_nodes * num_nodes);
+    matrix.path_offsets.assign(num_nodes * num_nodes + 1, 0);
+    std::vector<std::vector<StreetSegmentIdx>> row_segments(num_nodes);
+
+    // Dynamic, since a source near the edge of the map settles its targets much later than one in the middle
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t from = 0; from < num_nodes; from++) {
+        if (depots_backwards && !is_stop[from]) {
+            continue;
+        }
+        searchCourierMatrixRow(matrix, from, is_target, turn_penalty, row_segments[from]);
+    }
+
+    if (depots_backwards) {
+        searchDepotLegsBackwards(matrix, depot_nodes, pick_up_nodes, turn_penalty, row_segments);
+    }
+
+    // Path lengths to offsets, then every row's paths copied into place
+    for (size_t pair = 0; pair < num_nodes * num_nodes; pair++) {
+        matrix.path_offsets[pair + 1] += matrix.path_offsets[pair];
+    }
+    matrix.path_segments.resize(matrix.path_offsets.back());
 
-    // Populate all_interesting_paths using threading
     #pragma omp parallel for
-    for(int intersection_idx = 0; intersection_idx < interesting_intersections.size(); intersection_idx++){
-        
-        IntersectionIdx inter_id = interesting_intersections[intersection_idx];
-        std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> interesting_path_map = findAllPathsBetweenIntersections(inter_id, interesting_intersections, turn_penalty);
+    for (size_t from = 0; from < num_nodes; from++) {
+        std::copy(row_segments[from].begin(), row_segments[from].end(), matrix.path_segments.begin() + matrix.path_offsets[from * num_nodes]);
+        std::vector<StreetSegmentIdx>().swap(row_segments[from]);
+    }
+
+    matrix.build_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start_time).count();
+#ifdef ROUTING_STATS
+    std::clog << "MATRIX PRECOMPUTE: " << matrix.size() << " intersections in " << matrix.build_time << " s" << std::endl;
+#endif
+
+    return matrix;
+}
+
+// Dijkstra from one interesting intersection until every other is settled (the courier matrix
+// specialization of the search kernel). The travel times come straight from the search, and
+// the paths are traced back only for their segments
+void searchCourierMatrixRow(CourierMatrix& matrix,
+                            size_t from,
+                            const std::vector<char>& is_target,
+                            const double turn_penalty,
+                            std::vector<StreetSegmentIdx>& row_segments) {
+    SEARCH_STATS_RESET();
+
+    size_t num_nodes = matrix.intersections.size();
+    SearchWorkspace& workspace = threadSearchWorkspace();
+
+    // 4-ary heap since these searches cover much of the map and the wavefront gets large
+    AllTargetsStop stop_rule(is_target, static_cast<int>(num_nodes));
+    runSearch<QuadHeapQueue>(workspace, {WaveElem(matrix.intersections[from], NO_EDGE, 0, 0)}, get_profile_graph(DRIVING),
+                               NoHeuristic(), turn_penalty, stop_rule);
+
+    for (size_t to = 0; to < num_nodes; to++) {
+        size_t pair = from * num_nodes + to;
+        double travel_time = workspace.nodes[matrix.intersections[to]].bestTime;
+
+        // An unreachable pair has an empty path, which costs 0 like computePathTravelTime says it does
+        matrix.costs[pair] = (travel_time == DBL_MAX) ? 0 : static_cast<float>(travel_time);
+
+        std::vector<StreetSegmentIdx> path = bfsTraceBack(matrix.intersections[to]);
+        matrix.path_offsets[pair + 1] = path.size();
+        row_segments.insert(row_segments.end(), path.begin(), path.end());
+    }
+}
+
+// One Dijkstra per pick up on the reversed graph, until every depot is settled. A depot's path
+// is traced back towards the pick up, which is the order the truck drives it in reverse
+void searchDepotLegsBackwards(CourierMatrix& matrix,
+                              const std::vector<int>& depot_nodes,
+                              const std::vector<int>& pick_up_nodes,
+                              const double turn_penalty,
+                              std::vector<std::vector<StreetSegmentIdx>>& row_segments) {
+
+    size_t num_nodes = matrix.intersections.size();
+    size_t num_depots = depot_nodes.size();
+    size_t num_pick_ups = pick_up_nodes.size();
+
+    std::vector<char> is_depot(getNumIntersections(), 0);
+    for (int depot : depot_nodes) {
+        is_depot[matrix.intersections[depot]] = 1;
+    }
+
+    // Path of every depot -> pick up leg, by depot then pick up
+    std::vector<std::vector<std::vector<StreetSegmentIdx>>> legs(num_depots, std::vector<std::vector<StreetSegmentIdx>>(num_pick_ups));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t pick_up = 0; pick_up < num_pick_ups; pick_up++) {
+        SEARCH_STATS_RESET();
+        SearchWorkspace& workspace = threadSearchWorkspace();
+
+        AllTargetsStop stop_rule(is_depot, static_cast<int>(num_depots));
+        runSearch<QuadHeapQueue>(workspace, {WaveElem(matrix.intersections[pick_up_nodes[pick_up]], NO_EDGE, 0, 0)},
+                                 get_reverse_profile_graph(DRIVING), NoHeuristic(), turn_penalty, stop_rule);
+
+        for (size_t depot = 0; depot < num_depots; depot++) {
+            IntersectionIdx depot_intersection = matrix.intersections[depot_nodes[depot]];
+            double travel_time = workspace.nodes[depot_intersection].bestTime;
+            matrix.costs[depot_nodes[depot] * num_nodes + pick_up_nodes[pick_up]] = (travel_time == DBL_MAX) ? 0 : static_cast<float>(travel_time);
+
+            legs[depot][pick_up] = bfsTraceBack(depot_intersection);
+            std::reverse(legs[depot][pick_up].begin(), legs[depot][pick_up].end());
+        }
+    }
 
-        #pragma omp critical
-        {
-            all_interesting_paths[inter_id] = interesting_path_map;
+    // The pick ups are in node order, so each depot's legs go into its row in order
+    for (size_t depot = 0; depot < num_depots; depot++) {
+        for (size_t pick_up = 0; pick_up < num_pick_ups; pick_up++) {
+            size_t pair = depot_nodes[depot] * num_nodes + pick_up_nodes[pick_up];
+            matrix.path_offsets[pair + 1] = legs[depot][pick_up].size();
+            row_segments[depot_nodes[depot]].insert(row_segments[depot_nodes[depot]].end(), legs[depot][pick_up].begin(), legs[depot][pick_up].end());
         }
     }
+}
 
-    return all_interesting_paths;
+std::vector<StreetSegmentIdx> CourierMatrix::path(int from, int to) const {
+    size_t pair = static_cast<size_t>(from) * intersections.size() + to;
+    return std::vector<StreetSegmentIdx>(path_segments.begin() + path_offsets[pair], path_segments.begin() + path_offsets[pair + 1]);
 }
 
-std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> findAllPathsBetweenIntersections(
-                                                        const IntersectionIdx srcID,
-                                                        const std::vector<IntersectionIdx> destIDs, // Make a map?
-                                                        const double turn_penalty)
-{
-    std::vector<Node> nodes(getNumIntersections());    
+DepotTable::DepotTable(const CourierMatrix& matrix, const std::vector<IntersectionIdx>& depots) {
+    size_t num_nodes = matrix.intersections.size();
+    size_t num_depots = depots.size();
 
-    // Priority queue to store wavefront intersections to search
-    std::priority_queue<WaveElem, std::vector<WaveElem>, std::greater<WaveElem>> wavefront;
-    wavefront.push(WaveElem(srcID, NO_EDGE, 0, 0)); 
+    for (IntersectionIdx depot : depots) {
+        depot_nodes.push_back(matrix.node_of.at(depot));
+    }
 
-    // Perform BFS until wavefront is empty
-    while (wavefront.size() > 0)
-    {
-        // Get the intersection at the front of the wavefront
-        WaveElem curr = wavefront.top(); 
-        wavefront.pop();                
-
-        // Check if this is a better path to the current node
-        if (curr.travelTime < nodes[curr.nodeID].bestTime)
-        {
-            // Update best time and reaching edge for the current node
-            nodes[curr.nodeID].reachingEdge = curr.edgeID;
-            nodes[curr.nodeID].bestTime = curr.travelTime;
-            nodes[curr.nodeID].found = true;
-
-            // Get outgoing segments of the current intersection
-            nodes[curr.nodeID].out_edges = findStreetSegmentsOfIntersection(curr.nodeID);
-
-            // Explore each outgoing segment
-            for (StreetSegmentIdx out_edge : nodes[curr.nodeID].out_edges)
-            {
-                int toNodeID = 0;
-
-                // Determine ID of intersection 9accounting for one-way)
-                if (curr.nodeID == get_street_seg_from(out_edge))
-                {
-                    toNodeID = get_street_seg_to(out_edge);
-                }
-                else if (!get_street_seg_one_way(out_edge) && (curr.nodeID == get_street_seg_to(out_edge)))
-                {
-                    toNodeID = get_street_seg_from(out_edge);
-                }
-                else
-                {
-                    continue;
-                }
+    nearest_depot.assign(num_nodes, -1);
+    second_nearest_depot.assign(num_nodes, -1);
 
-                // Calculate travel time to the reached intersection
-                double travelTime;
-                if (nodes[curr.nodeID].reachingEdge != NO_EDGE && get_street_seg_street_id(nodes[curr.nodeID].reachingEdge) != get_street_seg_street_id(out_edge))
-                {
-                    travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge) + turn_penalty;
+    for (size_t node = 0; node < num_nodes; node++) {
+        for (int depot : depot_nodes) {
+            if (nearest_depot[node] == -1 || matrix.cost(depot, node) < matrix.cost(nearest_depot[node], node)) {
+                second_nearest_depot[node] = nearest_depot[node];
+                nearest_depot[node] = depot;
+            }
+            else if (second_nearest_depot[node] == -1 || matrix.cost(depot, node) < matrix.cost(second_nearest_depot[node], node)) {
+                second_nearest_depot[node] = depot;
+            }
+        }
+    }
+
+    // Every depot's trip back from each node laid out contiguously, so a row of the table is
+    // one straight sweep per depot
+    std::vector<std::vector<double>> back_to_depot(num_depots, std::vector<double>(num_nodes));
+    for (size_t depot = 0; depot < num_depots; depot++) {
+        for (size_t node = 0; node < num_nodes; node++) {
+            back_to_depot[depot][node] = matrix.cost(node, depot_nodes[depot]);
+        }
+    }
+
+    round_trip_depot.assign(num_nodes * num_nodes, -1);
+    round_trip_cost.assign(num_nodes * num_nodes, DBL_MAX);
+
+    #pragma omp parallel for
+    for (size_t first = 0; first < num_nodes; first++) {
+        int* best_depot = &round_trip_depot[first * num_nodes];
+        double* best_cost = &round_trip_cost[first * num_nodes];
+
+        for (size_t depot = 0; depot < num_depots; depot++) {
+            double out = matrix.cost(depot_nodes[depot], first);
+
+            for (size_t last = 0; last < num_nodes; last++) {
+                if (out + back_to_depot[depot][last] < best_cost[last]) {
+                    best_cost[last] = out + back_to_depot[depot][last];
+                    best_depot[last] = depot_nodes[depot];
                 }
-                else
-                {
-                    travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge);
+            }
+        }
+    }
+}
+// Builds one tour by always heading to the nearest legal stop, with a small chance of taking
+// the second nearest instead so repeated runs explore different tours
+PathOptions greedy_construction(const std::vector<DeliveryInf>& deliveries,
+                                const std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, bool>>& dropOffDependencies,
+                                const std::unordered_map<IntersectionIdx, std::unordered_set<IntersectionIdx>>& pickUpDependencies,
+                                const std::vector<IntersectionIdx>& r_drop_offs,
+                                const CourierMatrix& matrix,
+                                const DepotTable& depot_table,
+                                const ScheduleLimits& limits,
+                                CourierRng& rng) {
+    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, bool>> drop_off_dependencies = dropOffDependencies;
+    std::unordered_map<IntersectionIdx, std::unordered_set<IntersectionIdx>> pick_up_dependencies = pickUpDependencies;
+
+    std::vector<PickDrop> converted_solution;
+
+    CourierSubPath cur_sub_path;
+    int random;
+
+    double travel_time = 0;
+
+    IntersectionIdx nearest_depot;
+
+    // Find the depot closest to any of the delivery pick-up locations (each pick up's two nearest
+    // depots are enough to know the closest and second closest pair)
+    double best_distance = DBL_MAX;
+    double second_best_distance = DBL_MAX;
+    int best_depot = -1;
+    int second_best_depot = -1;
+
+    auto considerDepot = [&](int depot, int pick_up) {
+        if (depot == -1) {
+            return;
+        }
+
+        double distance = matrix.cost(depot, pick_up);
+        if (distance < best_distance) {
+            second_best_distance = best_distance;
+            second_best_depot = best_depot;
+            best_distance = distance;
+            best_depot = depot;
+        }
+        else if (distance < second_best_distance) {
+            second_best_distance = distance;
+            second_best_depot = depot;
+        }
+    };
+
+    for (const DeliveryInf& delivery : deliveries) {
+        int pick_up = matrix.node_of.at(delivery.pickUp);
+        considerDepot(depot_table.nearest_depot[pick_up], pick_up);
+        considerDepot(depot_table.second_nearest_depot[pick_up], pick_up);
+    }
+
+    random = rng.below(100);
+    if(random < 3 && second_best_depot != -1){
+        nearest_depot = matrix.intersections[second_best_depot];
+    }
+    else {
+        nearest_depot = matrix.intersections[best_depot];
+    }
+
+
+    // Create a copy of the deliveries vector
+    std::vector<DeliveryInf> remaining_deliveries = deliveries;
+    std::vector<IntersectionIdx> remaining_drop_offs = r_drop_offs;
+
+    // Keep track of visited pick-up locations
+    std::unordered_set<IntersectionIdx> visited_pickups;
+
+    // Iterate through deliveries
+    IntersectionIdx current_intersection = nearest_depot;
+
+    // With capacity or time windows, candidates are ranked by when they can be served, and the ones
+    // that would overload the truck or miss a window are left out
+    TruckState truck(limits);
+    auto timeTo = [&](IntersectionIdx intersection) {
+        double distance = matrix.cost(matrix.node_of.at(current_intersection), matrix.node_of.at(intersection));
+        if (!limits.active()) {
+            return distance;
+        }
+
+        double start = truck.serviceStart(intersection, distance);
+        return (start == DBL_MAX) ? DBL_MAX : std::max(distance, start - truck.time);
+    };
+    while (!remaining_drop_offs.empty()) {
+        // print_dropOffDependencies(dropOffDependencies);
+        // print_pickUpDependencies(pickUpDependencies);
+        IntersectionIdx pickUpIntersection = -1;
+        IntersectionIdx dropOffIntersection = -1; // might cause trouble
+
+        // Find the nearest legal pick-up or drop-off location
+        std::priority_queue<DeliveryOption> delivery_options;
+
+        for (auto& delivery : remaining_deliveries) {
+            // If a pickup intersection hasn't been visited
+            if (visited_pickups.count(delivery.pickUp) == 0 ) {
+                // std::cout << "Pickup hasn't been visited: " << delivery.pickUp << std::endl;
+                double pickup_distance = timeTo(delivery.pickUp);
+                if (pickup_distance != DBL_MAX) {
+                    delivery_options.push(DeliveryOption(pickup_distance, delivery, true));
                 }
+            }
 
-                // Only look at this node if there's a better travel time
-                if (travelTime < nodes[toNodeID].bestTime) {
-                    wavefront.push(WaveElem(toNodeID, out_edge, travelTime, 0)); 
+            // Check if all pickups required for this drop-off have been completed
+            bool allPickupsDone = true;
+            // std::cout << "  Checking for allPickupsDone for drop-off " << delivery.dropOff << ":" << std::endl;
+            if (drop_off_dependencies.find(delivery.dropOff) != drop_off_dependencies.end()) {
+                for (const auto& pickup : drop_off_dependencies[delivery.dropOff]) {
+                    // std::cout << "Pickup: " << pickup.first << ", Completed: " << std::boolalpha << pickup.second << std::endl;
+                    if (!pickup.second) { // If any pickup is not completed
+                        allPickupsDone = false;
+                        break;
+                    }
+                }
+            } 
+            else {
+                allPickupsDone = false;
+            }  
+
+            // You can go to the drop-off only if all the pickups have been done
+            if (allPickupsDone) {
+                double dropoff_distance = timeTo(delivery.dropOff);
+                if (dropoff_distance != DBL_MAX) {
+                    delivery_options.push(DeliveryOption(dropoff_distance, delivery, false));
                 }
             }
         }
-    }
 
-    std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> all_interesting_paths;
+        // Stuck: every stop left would break a constraint
+        if (delivery_options.empty()) {
+            return PathOptions({}, {}, DBL_MAX);
+        }
 
-    #pragma omp parallel for
-    for(int dest_idx = 0; dest_idx < destIDs.size(); dest_idx++){
+        DeliveryInf real_delivery(pickUpIntersection, dropOffIntersection);
+        bool pickup;
         
-        std::list<StreetSegmentIdx> path;
-        IntersectionIdx currNodeID = destIDs[dest_idx];
-        StreetSegmentIdx prevEdge = nodes[currNodeID].reachingEdge;
-
-        // Trace back until reaching the starting intersection
-        while (prevEdge != NO_EDGE)
-        {
-            // Add the previous edge to front of path list
-            path.push_front(prevEdge);
-
-            // Update the current intersection
-            if (currNodeID == get_street_seg_from(prevEdge))
-            {
-                currNodeID = get_street_seg_to(prevEdge);
+        random = rng.below(100);
+        if(random < 3 && delivery_options.size() >= 2){
+            delivery_options.pop();
+            DeliveryOption second_best_delivery =  delivery_options.top();          
+            real_delivery = second_best_delivery.delivery;
+            pickup = second_best_delivery.isPickup;
+        }
+
+        else {
+            DeliveryOption second_best_delivery =  delivery_options.top();          
+            real_delivery = second_best_delivery.delivery;
+            pickup = second_best_delivery.isPickup;
+        }
+        
+        PickDrop temp;
+
+        // Add the path to the nearest location to the solution
+        if (pickup) {
+            visited_pickups.insert(real_delivery.pickUp);
+            cur_sub_path.intersections = std::make_pair(current_intersection, real_delivery.pickUp);
+            current_intersection = real_delivery.pickUp;
+
+            temp.intersection_id = real_delivery.pickUp;
+            temp.isPickUp = 0;
+
+            // go through every delivery associated with this pickup and mark the pick up as complete
+            if(pick_up_dependencies.find(current_intersection) != pick_up_dependencies.end()) {
+                for(auto delivery: pick_up_dependencies[current_intersection]){
+                    /*
+                    if(drop_off_dependencies.find(delivery) != drop_off_dependencies.end() && 
+                        drop_off_dependencies[delivery].find(current_intersection) != drop_off_dependencies[delivery].end()){*/
+                        drop_off_dependencies[delivery][current_intersection] = true;  
+                    // }
+                }
             }
-            else
-            {
-                currNodeID = get_street_seg_from(prevEdge);
+        } 
+        
+        else {
+            visited_pickups.insert(real_delivery.dropOff); // same intersection can be pickUp and dropOff
+            cur_sub_path.intersections = std::make_pair(current_intersection, real_delivery.dropOff);
+            current_intersection = real_delivery.dropOff;
+
+            temp.intersection_id = real_delivery.dropOff;
+            temp.isPickUp = 1;
+
+            // go through every delivery associated with this pickup and mark the pick up as complete
+            if(pick_up_dependencies.find(current_intersection) != pick_up_dependencies.end()) {
+                for(auto delivery: pick_up_dependencies[current_intersection]){
+                    /*if(drop_off_dependencies.find(delivery) != drop_off_dependencies.end() && 
+                        drop_off_dependencies[delivery].find(current_intersection) != drop_off_dependencies[delivery].end()){ */
+                        drop_off_dependencies[delivery][current_intersection] = true;
+                    //}
+
+                    // This delivery is also a pick up
+                    temp.isPickUp = 2;
+                }
             }
 
-            // Update prevEdge
-            prevEdge = nodes[currNodeID].reachingEdge;
+            remaining_deliveries.erase(
+                std::remove_if(
+                    remaining_deliveries.begin(), 
+                    remaining_deliveries.end(),
+                    [current_intersection](const DeliveryInf& d) { return d.dropOff == current_intersection; }
+                ),
+                remaining_deliveries.end()
+            );
+
+            remaining_drop_offs.erase(
+                std::remove_if(
+                    remaining_drop_offs.begin(), 
+                    remaining_drop_offs.end(),
+                    [current_intersection](const IntersectionIdx& idx) { return idx == current_intersection; }
+                ),
+                remaining_drop_offs.end()
+            ); 
+
         }
 
-        if(currNodeID != srcID){
-            all_interesting_paths[destIDs[dest_idx]] = {std::begin(path), std::end(path)};
-        } else {
-            all_interesting_paths[destIDs[dest_idx]] = {std::begin(path), std::end(path)};
+        int from_node = matrix.node_of.at(cur_sub_path.intersections.first);
+        temp.node = matrix.node_of.at(temp.intersection_id);
+
+        converted_solution.push_back(temp);
+        travel_time += matrix.cost(from_node, temp.node);
+
+        if (limits.active()) {
+            truck.visit(temp.intersection_id, matrix.cost(from_node, temp.node));
         }
     }
 
-    nodes.clear();
-    return all_interesting_paths;   
+    // check if remaining intersections empty too
+
+    // Go back to the starting depot
+    cur_sub_path.intersections = std::make_pair(current_intersection, nearest_depot);
+    travel_time += matrix.cost(matrix.node_of.at(current_intersection), matrix.node_of.at(nearest_depot));
+
+    // Street segments are only filled in for the tours that get annealed
+    return PathOptions({}, converted_solution, travel_time);
 }
 
+// Best tour found for the deliveries: greedy multi-start, then the best few are annealed (or improved
+// by large neighbourhood search, see CourierOptions::tour_search) in parallel
+PathOptions solveCourierTour(const std::vector<DeliveryInf>& deliveries,
+                             const CourierMatrix& matrix,
+                             const DepotTable& depot_table,
+                             CourierProgress& progress) {
 
+    std::priority_queue<PathOptions> path_options;
 
-std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  fillPathCostMatrix(
-                        std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> all_paths, 
-                        const double turn_penalty){
+    // For every dropoff, store the pick ups that need to happen; for every pick up, store the drop offs that happen after it
+    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, bool>> dropOffDependencies;
+    std::unordered_map<IntersectionIdx, std::unordered_set<IntersectionIdx>> pickUpDependencies;
+    std::vector<IntersectionIdx> r_drop_offs;
 
-    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>> all_path_costs;
+    for (const auto& delivery : deliveries) {
+        if(dropOffDependencies.find(delivery.dropOff) == dropOffDependencies.end()){
+            r_drop_offs.push_back(delivery.dropOff);
+        }
+        dropOffDependencies[delivery.dropOff][delivery.pickUp] = false; // map every drop_off to its pick_up that need to happen before it
+        pickUpDependencies[delivery.pickUp].insert(delivery.dropOff); // map every delivery that needs to be made for a pickup
+    }
 
-    // Go through every intersting intersection
-    #pragma omp parallel for
-    for (int src_idx = 0; src_idx < all_paths.size(); src_idx++) {
+    ScheduleLimits limits(deliveries, progress.options.constraints);
 
-        auto src_it = std::next(all_paths.begin(), src_idx);
-        IntersectionIdx src_id = src_it->first;
+    // Few enough deliveries to try every order, unless the limits need the heuristic
+    if (!limits.active() && deliveries.size() <= EXACT_MAX_DELIVERIES) {
+        PathOptions exact_path = exact_courier_tour(deliveries, matrix, depot_table);
+        if (!exact_path.converted_path.empty()) {
+            progress.report(exact_path.converted_path, matrix, depot_table);
+        }
+        return exact_path;
+    }
+
+    // One annealing island per thread a parallel region here really gets. Islands share the time
+    // budget, so any more would run after the others and find it spent. omp_get_max_threads is
+    // not that when this already runs in parallel (a fleet truck) and nesting is off
+    int num_islands = 1;
+    #pragma omp parallel
+    {
+        #pragma omp single
+        num_islands = omp_get_num_threads();
+    }
+
+    // Each greedy tour has its own random stream, so the tours don't depend on which thread
+    // builds them. Each thread keeps only its best few, which are merged once every thread is done
+    std::vector<std::vector<PathOptions>> thread_best(omp_get_max_threads());
 
-        // Go through every intersection connect to the source intersection
-        for (auto dst_intersection : src_it->second){
-            
-            IntersectionIdx dst_id = dst_intersection.first;
-            double travel_time = computePathTravelTime(turn_penalty, dst_intersection.second);
+    #pragma omp parallel
+    {
+        std::vector<PathOptions> local_best;
+
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < GREEDY_ITERATIONS; i++) {
+            // Once asked to stop, a thread only finishes its first tour
+            if (!local_best.empty() && progress.shouldStop()) {
+                continue;
+            }
+
+            CourierRng rng(progress.options.seed, i);
+            PathOptions greedy_tour = greedy_construction(deliveries, dropOffDependencies, pickUpDependencies, r_drop_offs, matrix, depot_table, limits, rng);
+
+            // Only tours within the capacity and time windows can be annealed
+            if (greedy_tour.converted_path.empty() || (limits.active() && !meetsConstraints(greedy_tour.converted_path, matrix, limits))) {
+                continue;
+            }
+            local_best.push_back(std::move(greedy_tour));
 
-            #pragma omp critical
-            {
-                all_path_costs[src_id][dst_id] = travel_time;
+            // Trim back to the best num_islands once the list has doubled
+            if (local_best.size() >= 2 * static_cast<size_t>(num_islands)) {
+                std::nth_element(local_best.begin(), local_best.begin() + num_islands, local_best.end(),
+                                 [](const PathOptions& a, const PathOptions& b) { return a.travel_time < b.travel_time; });
+                local_best.resize(num_islands);
             }
-        }  
+        }
+
+        thread_best[omp_get_thread_num()] = std::move(local_best);
     }
 
-    return all_path_costs;
-}
-std::tuple<std::vector<PickDrop>, int> choosePerturbation(const std::vector<PickDrop>& solution, double temperature) {
-    // Define perturbation functions
-    std::vector<std::vector<PickDrop> (*)(std::vector<PickDrop>, double)> perturbationFunctions = {
-        shift,          // Minor perturbation
-        swap,           // Moderate perturbation
-        reverseSubsequence  // Significant perturbation
-    };
+    for (std::vector<PathOptions>& local_best : thread_best) {
+        for (PathOptions& option : local_best) {
+            path_options.push(std::move(option));
+        }
+    }
 
-    // Initial probabilities at temperature = 1
-    double random_value = rand() % 100;
+    std::vector <PathOptions> multi_start_paths;
+    for(int i = 0; i < num_islands && !path_options.empty(); i++){
+        PathOptions temp = path_options.top();
+        path_options.pop();
+#ifdef ROUTING_STATS
+        std::clog << "ORIGINAL TRAVEL TIME: " << temp.travel_time << std::endl;
+#endif
+        multi_start_paths.push_back(temp);
+    }
 
-    if(random_value < 5 && temperature > 50)
-        return {perturbationFunctions[1](solution, temperature), 1};
+    // The best greedy tour is the first anytime result
+    if (!multi_start_paths.empty()) {
+        progress.report(multi_start_paths.front().converted_path, matrix, depot_table);
+    }
 
-    if(random_value < 25 && temperature > 20)
-        return {perturbationFunctions[2](solution, temperature), 2};  
+    // The best greedy tour starts on the coolest island
+    IslandExchange islands(static_cast<int>(multi_start_paths.size()));
 
+    auto annealing_start = std::chrono::high_resolution_clock::now();
 
-    // Fallback to shift if no other perturbation is selected
-    return {perturbationFunctions[0](solution, temperature), 0};
-}
+    #pragma omp parallel for
+    for(int i = 0; i < multi_start_paths.size(); i++){
+        CourierRng rng(progress.options.seed, GREEDY_ITERATIONS + i);
+        if (progress.options.tour_search == TourSearch::LARGE_NEIGHBOURHOOD) {
+            multi_start_paths[i] = large_neighbourhood_search(multi_start_paths[i].converted_path, matrix, depot_table, limits, rng, progress, islands, i);
+        }
+        else {
+            multi_start_paths[i] = simulated_annealing(multi_start_paths[i].converted_path, matrix, depot_table, limits, rng, progress, islands, i);
+        }
+    }
+
+    progress.annealing_time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - annealing_start).count();
 
+    // Finding the PathOptions with the smallest travel time
+    PathOptions best_path_option({}, {}, std::numeric_limits<double>::max());
+
+    for (auto& path_option : multi_start_paths) {
+        if (path_option.travel_time < best_path_option.travel_time) {
+            best_path_option = path_option;
+        }
+    }
+
+    return best_path_option;
+}
 
-// Simulated Annealing function
-PathOptions simulated_annealing(std::vector<PickDrop> initial_solution, double initial_cost, 
-                                std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> path_matrix,
-                                std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>> path_cost_matrix,
-                                const std::vector<IntersectionIdx>& depots,
-                                std::chrono::time_point<std::chrono::high_resolution_clock> start_time) {
-    std::vector<int> perturbationSuccessCount = {0, 0, 0};  // Corresponds to shift, swap, reverseSubsequence
 
-    std::vector<PickDrop> solution = initial_solution;
-    double cost = initial_cost;
-    double best_cost = initial_cost;
-    std::vector<PickDrop> best_solution = initial_solution;
+// Simulated Annealing function. Each move is priced and checked on the tour in place, and
+// only performed if it is accepted. Local search polishes the start and the best tour after
+// every phase of ANNEALING_PHASE_MOVES moves, and a better best is reported at the phase end.
+// The start has to keep to the limits, and so does every move taken.
+// The run is one island of islands: it cools no further than its rung of the temperature
+// ladder, and every MIGRATION_PHASES phases trades best tours with its neighbour.
+// Stops when progress says so, or once convergence_moves moves go by without a new best
+PathOptions simulated_annealing(const std::vector<PickDrop>& initial_solution,
+                                const CourierMatrix& matrix,
+                                const DepotTable& depot_table,
+                                const ScheduleLimits& limits,
+                                CourierRng& rng,
+                                CourierProgress& progress,
+                                IslandExchange& islands,
+                                int island) {
+
+    // The tour is rebuilt over another island's stops when it migrates here
+    std::vector<PickDrop> stops = initial_solution;
+    std::unique_ptr<AnnealingTour> tour = std::make_unique<AnnealingTour>(stops, matrix, depot_table, limits);
+    localSearch(*tour);
+
+    double best_cost = tour->cost;
+    std::vector<int> best_order = tour->order;
+    long last_improvement = 0;
+    bool unreported = true;
+    bool unpublished = true;
 
     double temperature = 100; // High initial temperature
+    double temperature_floor = islandTemperatureFloor(island, islands.size());
     int iterations_since_improvement = 0;
 
-    while (true) {
-        auto [new_solution, chosen_perturbation_index] = choosePerturbation(solution, temperature);
-        double new_cost = solution_cost(new_solution, path_cost_matrix, depots);
-        double cost_difference = new_cost - cost;
+    long iteration;
+    for (iteration = 1; ; iteration++) {
+        TourMove move = chooseMove(*tour, temperature, rng);
 
-        if(legal_move(new_solution)){
+        if(tour->isLegal(move)){
+            double cost_difference = tour->costChange(move);
 
-            if (cost_difference < 0 || exp(-cost_difference / temperature) > static_cast<double>(rand()) / RAND_MAX) {
-                solution = new_solution;
-                cost = new_cost;
+            // The capacity and windows are only worth checking for a move that would be taken
+            if ((cost_difference < 0 || exp(-cost_difference / temperature) > rng.uniform()) && tour->meetsLimits(move)) {
+                tour->apply(move);
 
-                if (cost < best_cost) {
-                    best_cost = cost;
-                    best_solution = solution;
+                if (tour->cost < best_cost) {
+                    best_cost = tour->cost;
+                    best_order = tour->order;
+                    last_improvement = iteration;
+                    unreported = true;
+                    unpublished = true;
                     iterations_since_improvement = 0;
                 } else {
                     iterations_since_improvement++;
@@ -248,214 +702,143 @@ PathOptions simulated_annealing(std::vector<PickDrop> initial_solution, double i
             if (iterations_since_improvement > 100) {
                 temperature *= 0.9;
                 iterations_since_improvement = 0;
-                solution = best_solution;
+                tour->setOrder(best_order);
             } else {
                 temperature *= 0.95;
             }
+
+            // Left alone the temperature sinks into denormals, which make every division above very slow
+            temperature = std::max(temperature, temperature_floor);
         }
 
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        auto wallClock = std::chrono::duration_cast<std::chrono::duration<double>>(currentTime - start_time);
-        if (wallClock.count() > 0.9 * TIME_LIMIT) break;
-    }
+        if (iteration % ANNEALING_PHASE_MOVES == 0) {
+            tour->setOrder(best_order);
+            if (localSearch(*tour)) {
+                best_cost = tour->cost;
+                best_order = tour->order;
+                last_improvement = iteration;
+                unreported = true;
+                unpublished = true;
+            }
 
-    return PathOptions(PDDToCSP(best_solution, path_matrix, path_cost_matrix, depots), best_solution, best_cost);
-}
+            if (unreported) {
+                progress.report(tour->solution(best_order), matrix, depot_table);
+                unreported = false;
+            }
 
-std::vector<PickDrop> legalize(std::vector<PickDrop> current_solution) {
-    std::unordered_map<IntersectionIdx, size_t> seenDropoffs; // Map to store the index of seen drop-offs
-    bool legal = legal_move(current_solution);
-    
-    if (legal) { 
-        return current_solution;
-    }
-    else {
-        // Iterate through the solution
-        for (size_t i = 0; i < current_solution.size(); ++i) {
-            // If it's a drop-off, store its index
-            if (current_solution[i].isPickUp == 1 || current_solution[i].isPickUp == 2) {
-                seenDropoffs[current_solution[i].intersection_id] = i;
-            } 
-            // If it's a pick-up, check if any of its drop-offs are out of order
-            else {
-                for (const auto& dropoff : current_solution[i].drop_offs) {
-                    auto it = seenDropoffs.find(dropoff);
-                    if (it != seenDropoffs.end()) {
-                        auto temp = current_solution[it->second];
-                        // Erase the drop-off from its previous position
-                        current_solution.erase(current_solution.begin() + it->second);
-                        // Insert the drop-off into the index right after the pick-up
-                        current_solution.insert(current_solution.begin() + i + 1, temp);
-                        // Update the index of the moved drop-off
-                        seenDropoffs[dropoff] = i + 1;
-                    }
+            if (iteration % (MIGRATION_PHASES * ANNEALING_PHASE_MOVES) == 0) {
+                if (unpublished) {
+                    islands.publish(island, tour->solution(best_order), best_cost);
+                    unpublished = false;
                 }
-            }
-        }
-        return current_solution;
-    }
-}
 
-// Check if solution is legal
-bool legal_move(std::vector<PickDrop> solution) {
-    std::unordered_set<IntersectionIdx> seen_drop_off;
+                // A better neighbour replaces this island's tour, and counts as a new best here
+                const IslandElite* immigrant = islands.neighbour(island);
+                if (immigrant != nullptr && immigrant->cost < best_cost - IMPROVEMENT_EPSILON) {
+                    stops = immigrant->solution;
+                    tour = std::make_unique<AnnealingTour>(stops, matrix, depot_table, limits);
 
-    // Iterate through solution
-    for (auto pick_drop = solution.rbegin(); pick_drop != solution.rend(); pick_drop++){
-        
-        // If intersection is a drop off or both a drop off and pickup
-        if(pick_drop->isPickUp == 1 || pick_drop->isPickUp == 2){
-            seen_drop_off.insert(pick_drop->intersection_id);
-        }   
-
-        // Make sure the drop off happens after a pick up - search through all the drop offs associated with the pick up and make sure it happesn after
-        if(pick_drop->isPickUp == 0 || pick_drop->isPickUp == 2){
-            for(int i = 0; i < pick_drop->drop_offs.size(); i++){
-                if(seen_drop_off.find(pick_drop->drop_offs[i]) == seen_drop_off.end()){
-                    return false;
+                    best_cost = tour->cost;
+                    best_order = tour->order;
+                    last_improvement = iteration;
+                    iterations_since_improvement = 0;
                 }
             }
         }
-    }
 
-    return true;
-}
-
-// ------------------------- PERTUBATION FUNCTION -------------------------
-std::vector<PickDrop> shift(std::vector<PickDrop> current_solution, double temperature) {
-    if (current_solution.size() < 2) {
-        return current_solution; // No shift possible if there's 0 or 1 item
+        // A move is now cheaper than reading the clock, so only check it every so often
+        if (iteration % TIME_CHECK_INTERVAL == 0) {
+            if (progress.shouldStop() || iteration - last_improvement > progress.options.convergence_moves) break;
+        }
     }
 
-    int bound = temperature/10;
-
-    if(bound < 1){
-        bound = 1;
+    // Price the result from scratch rather than trusting the running sums
+    std::vector<PickDrop> best_solution = tour->solution(best_order);
+    if (unreported) {
+        progress.report(best_solution, matrix, depot_table);
     }
 
-    std::vector<PickDrop> solution = current_solution;
-    int old_index = rand() % solution.size();
-
-    // Calculate the valid bounds for new_index
-    int lower_bound = std::max(0, (old_index - 10));
-    int upper_bound = std::min(static_cast<int>(solution.size()) - 1, old_index + 10);
-
-    // Generate new_index within the bounds
-    int range = upper_bound - lower_bound + 1; // +1 because upper_bound is inclusive
-    int new_index = lower_bound + (rand() % range);
-
-    // Perform the shift
-    PickDrop temp = solution[old_index];
-    solution.erase(solution.begin() + old_index);
-
-    // Adjust new_index for the change in vector size after erase if necessary
-    if (new_index > old_index) {
-        new_index--; // Decrease by 1 because the original list size has reduced by 1
+    // Islands still running can take this tour over once this one is done
+    if (unpublished) {
+        islands.publish(island, best_solution, best_cost);
     }
 
-    solution.insert(solution.begin() + new_index, temp);
-
-    return solution;
+    progress.annealing_moves.fetch_add(iteration, std::memory_order_relaxed);
+    return PathOptions(PDDToCSP(best_solution, matrix, depot_table), best_solution, solution_cost(best_solution, matrix, depot_table));
 }
 
-std::vector<PickDrop> swap(std::vector<PickDrop> current_solution, double temperature) {
-    int n = current_solution.size();
-    if (n < 2) {
-        return current_solution; // No swap possible if there's less than two items
-    }
-
-    int index1 = rand() % n;
-    int max_distance = std::max(1, static_cast<int>(n * temperature / 10000)); // Dynamic distance based on temperature
-
-    int index2 = (index1 + (rand() % (2 * max_distance + 1) - max_distance) + n) % n; // Wrap around using modulo
-
-    if (index1 != index2) {
-        std::swap(current_solution[index1], current_solution[index2]);
-    }
+CourierProgress::CourierProgress(const CourierOptions& opts, std::chrono::time_point<std::chrono::high_resolution_clock> start_time)
+    : options(opts),
+      deadline(start_time + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(std::chrono::duration<double>(0.9 * opts.time_budget))) {
+}
 
-    return current_solution;
+bool CourierProgress::shouldStop() const {
+    return (options.stop != nullptr && options.stop->load(std::memory_order_relaxed)) ||
+           std::chrono::high_resolution_clock::now() > deadline;
 }
 
-std::vector<PickDrop> reverseSubsequence(std::vector<PickDrop> current_solution, double temperature) {
-    int n = current_solution.size();
-    if (n < 2) {
-        return current_solution; // No reverse possible if there's less than two items
+void CourierProgress::report(const std::vector<PickDrop>& solution, const CourierMatrix& matrix, const DepotTable& depot_table) {
+    if (!options.on_improvement) {
+        return;
     }
 
-    int start = rand() % n;
-    int length = std::max(2, static_cast<int>(n /** temperature / 10000*/)); // Subsequence length depends on temperature
-    int end = std::min(start + length - 1, n - 1);
+    double travel_time = solution_cost(solution, matrix, depot_table);
 
-    std::reverse(current_solution.begin() + start, current_solution.begin() + end + 1);
-
-    return current_solution;
+    // One report at a time, and only routes better than everything reported before
+    std::lock_guard<std::mutex> guard(report_lock);
+    if (travel_time < best_reported) {
+        best_reported = travel_time;
+        options.on_improvement(PDDToCSP(solution, matrix, depot_table), travel_time);
+    }
 }
 
+// Solution cost calculation function: plain array lookups along the tour
+double solution_cost(const std::vector<PickDrop>& solution,
+                    const CourierMatrix& matrix,
+                    const DepotTable& depot_table) {
 
+    int first_node = solution.front().node;
+    int last_node = solution.back().node;
 
-
-// Solution cost calculation function - TODO
-double solution_cost(std::vector<PickDrop> solution,
-                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  path_cost_matrix,
-                    const std::vector<IntersectionIdx>& depots) {
-
-    // Find the depot closest to any of the delivery pick-up locations
-    std::priority_queue<DepotOption> depot_options;
-    for (auto depot : depots) {
-        double distance = (path_cost_matrix[depot][solution[0].intersection_id] + path_cost_matrix[solution[solution.size() - 1].intersection_id][depot])/2;
-        depot_options.push(DepotOption(distance, depot));
-    }
-
-    DepotOption best_depot = depot_options.top();
-    IntersectionIdx nearest_depot = best_depot.depot_id;
-
-    double cost = path_cost_matrix[nearest_depot][solution[0].intersection_id];
+    // Cheapest trip from a depot out to the first stop and back from the last
+    double cost = depot_table.cost(first_node, last_node);
 
     // Go thorugh the rest of the solution
-    for(int index = 0 ; index < solution.size() - 1; index++){
-        cost += path_cost_matrix[solution[index].intersection_id][solution[index + 1].intersection_id];
+    for (size_t index = 0; index + 1 < solution.size(); index++) {
+        cost += matrix.cost(solution[index].node, solution[index + 1].node);
     }
 
-    cost += path_cost_matrix[solution[solution.size() - 1].intersection_id][nearest_depot];
-
     return cost;
 }
 
-// Conversion function PDD to CSP - TODO
-std::vector<CourierSubPath> PDDToCSP(std::vector<PickDrop> solution, 
-                                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> path_matrix,
-                                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  path_cost_matrix,
-                                    const std::vector<IntersectionIdx>& depots) {
+// Conversion function PDD to CSP
+std::vector<CourierSubPath> PDDToCSP(const std::vector<PickDrop>& solution, 
+                                    const CourierMatrix& matrix,
+                                    const DepotTable& depot_table) {
 
     std::vector<CourierSubPath> converted_solution;
     CourierSubPath cur_sub_path;
 
-    // Find the depot closest to any of the delivery pick-up locations
-    std::priority_queue<DepotOption> depot_options;
-    for (auto depot : depots) {
-        double distance = (path_cost_matrix[depot][solution[0].intersection_id] + path_cost_matrix[solution[solution.size() - 1].intersection_id][depot])/2;
-        depot_options.push(DepotOption(distance, depot));
-    }
+    int first_node = solution.front().node;
+    int last_node = solution.back().node;
 
-    DepotOption best_depot = depot_options.top();
-    IntersectionIdx nearest_depot = best_depot.depot_id;
+    // Depot with the cheapest trip out to the first stop and back from the last
+    int nearest_depot = depot_table.bestDepot(first_node, last_node);
     
-    cur_sub_path.intersections = std::make_pair(nearest_depot, solution[0].intersection_id);
-    cur_sub_path.subpath = path_matrix[cur_sub_path.intersections.first][cur_sub_path.intersections.second];
+    cur_sub_path.intersections = std::make_pair(matrix.intersections[nearest_depot], solution.front().intersection_id);
+    cur_sub_path.subpath = matrix.path(nearest_depot, first_node);
     converted_solution.push_back(cur_sub_path);
 
     // Go thorugh the rest of the solution
-    for(int index = 0 ; index < solution.size() - 1; index++){
-        IntersectionIdx current_intersection = solution[index].intersection_id;
-        IntersectionIdx next_intersection = solution[index + 1].intersection_id;
-        cur_sub_path.intersections = std::make_pair(current_intersection, next_intersection);
-        cur_sub_path.subpath = path_matrix[cur_sub_path.intersections.first][cur_sub_path.intersections.second];
+    for (size_t index = 0; index + 1 < solution.size(); index++) {
+        cur_sub_path.intersections = std::make_pair(solution[index].intersection_id, solution[index + 1].intersection_id);
+        cur_sub_path.subpath = matrix.path(solution[index].node, solution[index + 1].node);
         converted_solution.push_back(cur_sub_path);
     }
 
     // Last intersection back to depot
-    cur_sub_path.intersections = std::make_pair(solution[solution.size() - 1].intersection_id, nearest_depot);
-    cur_sub_path.subpath = path_matrix[cur_sub_path.intersections.first][cur_sub_path.intersections.second];
+    cur_sub_path.intersections = std::make_pair(solution.back().intersection_id, matrix.intersections[nearest_depot]);
+    cur_sub_path.subpath = matrix.path(last_node, nearest_depot);
     converted_solution.push_back(cur_sub_path);
 
     return converted_solution;
@@ -6,12 +6,20 @@
  * Description: 
  */
 
+#ifndef M4_HELPER_H
+#define M4_HELPER_H
+
 #include "m1.h"
 #include "m1_globals.h"
 #include "m3.h"
 #include "m3_helper.h"
+#include "search_kernel.h"
+#include "search_stats.h"
 #include "m4.h"
+#include "courier_rng.h"
+#include "courier_constraints.h"
 #include <unordered_set>
+#include <unordered_map>
 #include <map>
 #include <queue>
 #include <list>
@@ -24,23 +32,34 @@
 #include <string>
 #include <vector>
 #include <tuple> 
+#include <random>
+#include <omp.h>
+#include <atomic>
+#include <mutex>
+#include <float.h>
 
+// Default time budget of travelingCourier, in seconds
 #define TIME_LIMIT 50
 
+// Annealing moves without a new best after which a run has converged
+#define CONVERGENCE_MOVES 2000000
 
-struct DepotOption {
-    double distance;
-    IntersectionIdx depot_id;
+// Annealing moves between reads of the clock, and the coldest the annealing gets
+#define TIME_CHECK_INTERVAL 256
+#define MIN_TEMPERATURE 1e-6
 
-    // Constructor for ease of use
-    DepotOption(double dist, IntersectionIdx idx)
-        : distance(dist), depot_id(idx) {}
+// Annealing moves between local search passes over the best tour
+#define ANNEALING_PHASE_MOVES 65536
+
+// Greedy tours built before annealing. The best one per thread gets annealed
+#define GREEDY_ITERATIONS 2000
 
-    // Comparator for sorting (if using priority queue)
-    bool operator<(const DepotOption& other) const {
-        return distance > other.distance; // Min heap
-    }
-};
+
+// Capacity and time windows of one problem, see truck_schedule.h
+struct ScheduleLimits;
+
+// Best tours the annealing runs trade, see annealing_islands.h
+class IslandExchange;
 
 struct DeliveryOption {
     double distance;
@@ -57,14 +76,16 @@ struct DeliveryOption {
     }
 };
 
-// Struct to store solution for easy peturbation
+// Struct to store solution for easy peturbation. Plain values only, so tours copy as flat arrays;
+// which drop offs a pick up has to come before is looked up per problem in ScheduleLimits
 struct PickDrop {
     
     // 0 = pickup, 1 = dropoff, 2 = both
     int isPickUp;
     IntersectionIdx intersection_id;
-    std::vector<IntersectionIdx> pick_ups;
-    std::vector<IntersectionIdx> drop_offs;
+
+    // Index of intersection_id in the CourierMatrix
+    int node;
 };
 
 
@@ -86,48 +107,216 @@ struct PathOptions {
     }
 };
 
+// Travel times and paths between every pair of interesting intersections. The intersections
+// are renumbered 0..K-1 (nodes) so every lookup is plain array indexing.
+// There's no turn penalty where one path meets the next at a stop: a route's travel time is the
+// sum of its subpaths' computePathTravelTime, each on its own, so tours are priced the same way.
+// A depot's row may only be filled in for the pick ups (the only place a truck drives to from a
+// depot), every other pair of it left at 0 with no path
+struct CourierMatrix {
+
+    // Intersection of each node, and the node of each intersection
+    std::vector<IntersectionIdx> intersections;
+    std::unordered_map<IntersectionIdx, int> node_of;
+
+    // K x K travel times, row-major (from * K + to)
+    std::vector<float> costs;
+
+    // Paths of every pair back to back in row-major order, the path from -> to is
+    // path_segments[path_offsets[from * K + to], path_offsets[from * K + to + 1])
+    std::vector<StreetSegmentIdx> path_segments;
+    std::vector<size_t> path_offsets;
+
+    // Wall clock seconds computeCourierMatrix took
+    double build_time = 0;
+
+    int size() const {
+        return static_cast<int>(intersections.size());
+    }
+
+    float cost(int from, int to) const {
+        return costs[static_cast<size_t>(from) * intersections.size() + to];
+    }
+
+    // Number of street segments on the path from -> to
+    size_t pathLength(int from, int to) const {
+        size_t pair = static_cast<size_t>(from) * intersections.size() + to;
+        return path_offsets[pair + 1] - path_offsets[pair];
+    }
+
+    std::vector<StreetSegmentIdx> path(int from, int to) const;
+};
+
+// Best depot for the ends of a tour, looked up instead of scanning every depot. A truck leaves
+// from and returns to the same depot, so the best one depends on both the first and last stop
+struct DepotTable {
+
+    // Node of each usable depot
+    std::vector<int> depot_nodes;
+
+    // K x K, row-major (first * K + last): the depot with the cheapest depot -> first + last -> depot,
+    // and that cost
+    std::vector<int> round_trip_depot;
+    std::vector<double> round_trip_cost;
+
+    // Depots with the cheapest and second cheapest drive out to each node (-1 with only one depot)
+    std::vector<int> nearest_depot;
+    std::vector<int> second_nearest_depot;
+
+    DepotTable(const CourierMatrix& matrix, const std::vector<IntersectionIdx>& depots);
+
+    int bestDepot(int first_node, int last_node) const {
+        return round_trip_depot[static_cast<size_t>(first_node) * nearest_depot.size() + last_node];
+    }
+
+    double cost(int first_node, int last_node) const {
+        return round_trip_cost[static_cast<size_t>(first_node) * nearest_depot.size() + last_node];
+    }
+};
+
+// Where the time of one travelingCourier call went, for comparing solver changes
+struct CourierStats {
+
+    // Wall clock seconds building the cost matrix, and annealing (every run at once)
+    double precompute_time = 0;
+    double annealing_time = 0;
+
+    // Annealing moves (or ruin and recreate iterations) tried by every run together
+    long annealing_moves = 0;
+
+    // Travel time of the returned route(s) by the cost matrix, which should match
+    // compute_courier_path_travel_time up to float rounding
+    double tour_cost = 0;
+};
+
+// How solveCourierTour improves its best greedy tours
+enum class TourSearch {
+    ANNEALING = 0,       // simulated_annealing
+    LARGE_NEIGHBOURHOOD  // large_neighbourhood_search, see large_neighbourhood.h
+};
+
+// Run time settings of travelingCourier
+struct CourierOptions {
+
+    // Wall clock seconds the whole call may take, the search wraps up at 90% of it
+    double time_budget = TIME_LIMIT;
+
+    // Annealing moves without a new best after which a run stops early
+    long convergence_moves = CONVERGENCE_MOVES;
+
+    // Seed of every random choice. Greedy tour i uses stream i of it and annealing run j
+    // stream GREEDY_ITERATIONS + j, so a seed always makes the same choices
+    uint64_t seed = COURIER_SEED;
+
+    // Anytime results: called with each route better than all the ones before it and its
+    // travel time, from whichever solver thread found it but never two calls at once
+    std::function<void(const std::vector<CourierSubPath>&, double)> on_improvement;
+
+    // Polled by the search, which returns its best route soon after this becomes true
+    const std::atomic<bool>* stop = nullptr;
+
+    // Item weights, truck capacity and time windows, none by default
+    CourierConstraints constraints;
+
+    // Large neighbourhood search found cheaper single truck tours than annealing at every size
+    // tried (up to 250 deliveries), annealing is kept for comparison
+    TourSearch tour_search = TourSearch::LARGE_NEIGHBOURHOOD;
+
+    // Filled in before the call returns, if set
+    CourierStats* stats = nullptr;
+};
+
+// travelingCourier with explicit run time settings
+std::vector<CourierSubPath> travelingCourier(const float turn_penalty,
+                                            const std::vector<DeliveryInf>& deliveries,
+                                            const std::vector<IntersectionIdx>& all_depots,
+                                            const CourierOptions& options);
+
+// State shared by the annealing runs of one travelingCourier call
+struct CourierProgress {
+    const CourierOptions& options;
+    std::chrono::time_point<std::chrono::high_resolution_clock> deadline;
+
+    std::mutex report_lock;
+    double best_reported = DBL_MAX;
+
+    // Annealing moves (or ruin and recreate iterations) tried by every run, and wall clock
+    // seconds of the annealing
+    std::atomic<long> annealing_moves{0};
+    double annealing_time = 0;
+
+    CourierProgress(const CourierOptions& opts, std::chrono::time_point<std::chrono::high_resolution_clock> start_time);
+
+    // Out of time or asked to stop
+    bool shouldStop() const;
+
+    // Passes the solution to options.on_improvement if it beats everything reported so far
+    void report(const std::vector<PickDrop>& solution, const CourierMatrix& matrix, const DepotTable& depot_table);
+};
+
+// Depots in the same strongly connected component as every delivery, empty if there are no
+// deliveries, they can't all reach each other or no depot can reach them
+std::vector<IntersectionIdx> reachable_depots(const std::vector<DeliveryInf>& deliveries,
+                                              const std::vector<IntersectionIdx>& depots);
+
 std::vector<IntersectionIdx> remove_duplicate_intersections(const std::vector<DeliveryInf>& deliveries,
                                                             const std::vector<IntersectionIdx>& depots);
 
 
                                             
-std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> fillPathMatrix(
-                                                                        const std::vector<IntersectionIdx>& interesting_intersections, // All unique intersections
-                                                                        const double turn_penalty); // Turn penalty for bfs
- 
+// Cost matrix over every pick up, drop off and depot
+CourierMatrix computeCourierMatrix(const std::vector<DeliveryInf>& deliveries,
+                                   const std::vector<IntersectionIdx>& depots,
+                                   const double turn_penalty);
 
-std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> findAllPathsBetweenIntersections(
-                                                        const IntersectionIdx srcID,
-                                                        const std::vector<IntersectionIdx> destIDs, 
-                                                        const double turn_penalty);
+// Fills row from of the matrix: its costs, and the lengths of its paths in the offset slots
+// (not yet summed) with the paths themselves back to back in row_segments
+void searchCourierMatrixRow(CourierMatrix& matrix,
+                            size_t from,
+                            const std::vector<char>& is_target,
+                            const double turn_penalty,
+                            std::vector<StreetSegmentIdx>& row_segments);
 
+// The depot -> pick up legs of the matrix found backwards, one search per pick up, for when there
+// are more depots (that aren't also stops) than pick ups. Both lists are in node order
+void searchDepotLegsBackwards(CourierMatrix& matrix,
+                              const std::vector<int>& depot_nodes,
+                              const std::vector<int>& pick_up_nodes,
+                              const double turn_penalty,
+                              std::vector<std::vector<StreetSegmentIdx>>& row_segments);
 
-std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  fillPathCostMatrix(
-                        std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> all_paths, 
-                        const double turn_penalty);
+PathOptions greedy_construction(const std::vector<DeliveryInf>& deliveries,
+                                const std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, bool>>& dropOffDependencies,
+                                const std::unordered_map<IntersectionIdx, std::unordered_set<IntersectionIdx>>& pickUpDependencies,
+                                const std::vector<IntersectionIdx>& r_drop_offs,
+                                const CourierMatrix& matrix,
+                                const DepotTable& depot_table,
+                                const ScheduleLimits& limits,
+                                CourierRng& rng);
 
+// Best single truck tour for the deliveries: greedy multi-start, then annealing
+PathOptions solveCourierTour(const std::vector<DeliveryInf>& deliveries,
+                             const CourierMatrix& matrix,
+                             const DepotTable& depot_table,
+                             CourierProgress& progress);
 
 // Simulated Annealing functions
-PathOptions simulated_annealing(std::vector<PickDrop> initial_solution, double initial_cost, 
-                                                std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> path_matrix,
-                                                std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  path_cost_matrix,
-                                                const std::vector<IntersectionIdx>& depots,
-                                                std::chrono::time_point<std::chrono::high_resolution_clock> start_time);
-
-
+PathOptions simulated_annealing(const std::vector<PickDrop>& initial_solution,
+                                                const CourierMatrix& matrix,
+                                                const DepotTable& depot_table,
+                                                const ScheduleLimits& limits,
+                                                CourierRng& rng,
+                                                CourierProgress& progress,
+                                                IslandExchange& islands,
+                                                int island);
 
-bool legal_move(std::vector<PickDrop> solution);
-std::vector<PickDrop> swap(std::vector<PickDrop> current_solution, double temperature); 
-std::vector<PickDrop> shift(std::vector<PickDrop> current_solution, double temperature);
-std::vector<PickDrop> reverseSubsequence(std::vector<PickDrop> current_solution, double temperature) ;
 
-double solution_cost(std::vector<PickDrop> solution,
-                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  path_cost_matrix,
-                    const std::vector<IntersectionIdx>& depots);
+double solution_cost(const std::vector<PickDrop>& solution,
+                    const CourierMatrix& matrix,
+                    const DepotTable& depot_table);
 
-std::vector<CourierSubPath> PDDToCSP(std::vector<PickDrop> solution, 
-                                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>>> path_matrix,
-                                    std::unordered_map<IntersectionIdx, std::unordered_map<IntersectionIdx, double>>  path_cost_matrix,
-                                    const std::vector<IntersectionIdx>& depots);
+std::vector<CourierSubPath> PDDToCSP(const std::vector<PickDrop>& solution, 
+                                    const CourierMatrix& matrix,
+                                    const DepotTable& depot_table);
 
-std::tuple<std::vector<PickDrop>, int> choosePerturbation(const std::vector<PickDrop>& solution, double temperature);
+#endif
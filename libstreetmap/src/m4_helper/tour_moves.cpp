@@ -0,0 +1,519 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Annealing moves with constant time pricing, see tour_moves.h
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include "tour_moves.h"
+
+AnnealingTour::AnnealingTour(const std::vector<PickDrop>& tour_stops,
+                             const CourierMatrix& courier_matrix,
+                             const DepotTable& depots,
+                             const ScheduleLimits& schedule_limits)
+    : stops(tour_stops), matrix(courier_matrix), depot_table(depots),
+      limits(schedule_limits.active() ? &schedule_limits : nullptr) {
+
+    int num_stops = static_cast<int>(stops.size());
+    must_precede.resize(num_stops);
+    must_follow.resize(num_stops);
+
+    // Every stop where something is dropped off, by intersection
+    std::unordered_map<IntersectionIdx, std::vector<int>> drop_off_stops;
+    for (int stop = 0; stop < num_stops; stop++) {
+        if (stops[stop].isPickUp == 1 || stops[stop].isPickUp == 2) {
+            drop_off_stops[stops[stop].intersection_id].push_back(stop);
+        }
+    }
+
+    // A pick up comes before the drop off stops of its deliveries
+    for (int stop = 0; stop < num_stops; stop++) {
+        if (stops[stop].isPickUp != 0 && stops[stop].isPickUp != 2) {
+            continue;
+        }
+
+        auto picked_up = schedule_limits.picked_up_at.find(stops[stop].intersection_id);
+        if (picked_up == schedule_limits.picked_up_at.end()) {
+            continue;
+        }
+
+        for (int delivery : picked_up->second) {
+            auto found = drop_off_stops.find(schedule_limits.deliveries[delivery].dropOff);
+            if (found == drop_off_stops.end()) {
+                continue;
+            }
+
+            for (int drop_off_stop : found->second) {
+                if (drop_off_stop != stop) {
+                    must_follow[stop].push_back(drop_off_stop);
+                    must_precede[drop_off_stop].push_back(stop);
+                }
+            }
+        }
+    }
+
+    // With constraints, the stop each item is picked up and dropped off at has to stay the one it is
+    // in the starting tour (a first visit has to stay the first), or a move could change the load
+    // and windows of stops it never touched
+    if (limits != nullptr) {
+        std::vector<IntersectionIdx> stop_intersections;
+        for (const PickDrop& stop : stops) {
+            stop_intersections.push_back(stop.intersection_id);
+        }
+
+        std::vector<int> pick_up_stop;
+        std::vector<int> drop_off_stop;
+        assignStops(stop_intersections, *limits, pick_up_stop, drop_off_stop);
+
+        // Stops at the same intersection keep their order
+        std::unordered_map<IntersectionIdx, int> last_stop_at;
+        std::vector<int> previous_at_intersection(num_stops, -1);
+        for (int stop = 0; stop < num_stops; stop++) {
+            auto found = last_stop_at.find(stop_intersections[stop]);
+            if (found != last_stop_at.end()) {
+                previous_at_intersection[stop] = found->second;
+                addOrder(found->second, stop);
+            }
+            last_stop_at[stop_intersections[stop]] = stop;
+        }
+
+        effects.resize(num_stops);
+        for (int delivery = 0; delivery < static_cast<int>(pick_up_stop.size()); delivery++) {
+            int pick_up = pick_up_stop[delivery];
+            int drop_off = drop_off_stop[delivery];
+
+            // The drop off stays the first stop at its intersection after the pick up
+            if (pick_up != drop_off) {
+                addOrder(pick_up, drop_off);
+                if (previous_at_intersection[drop_off] != -1) {
+                    addOrder(previous_at_intersection[drop_off], pick_up);
+                }
+
+                effects[pick_up].load_change += limits->weight(delivery);
+                effects[drop_off].load_change -= limits->weight(delivery);
+            }
+
+            TimeWindow pick_up_window = limits->pickUpWindow(delivery);
+            TimeWindow drop_off_window = limits->dropOffWindow(delivery);
+            effects[pick_up].window.open = std::max(effects[pick_up].window.open, pick_up_window.open);
+            effects[pick_up].window.close = std::min(effects[pick_up].window.close, pick_up_window.close);
+            effects[drop_off].window.open = std::max(effects[drop_off].window.open, drop_off_window.open);
+            effects[drop_off].window.close = std::min(effects[drop_off].window.close, drop_off_window.close);
+        }
+    }
+
+    std::vector<int> initial_order(num_stops);
+    std::iota(initial_order.begin(), initial_order.end(), 0);
+
+    // Nearest neighbours by travel time from the stop
+    neighbours.resize(num_stops);
+    for (int stop = 0; stop < num_stops; stop++) {
+        std::vector<int>& nearest = neighbours[stop];
+        for (int other = 0; other < num_stops; other++) {
+            if (other != stop) {
+                nearest.push_back(other);
+            }
+        }
+
+        int num_nearest = std::min(NUM_NEIGHBOURS, static_cast<int>(nearest.size()));
+        std::partial_sort(nearest.begin(), nearest.begin() + num_nearest, nearest.end(), [&](int a, int b) {
+            return matrix.cost(stops[stop].node, stops[a].node) < matrix.cost(stops[stop].node, stops[b].node);
+        });
+        nearest.resize(num_nearest);
+    }
+
+    setOrder(initial_order);
+}
+
+void AnnealingTour::setOrder(const std::vector<int>& new_order) {
+    order = new_order;
+    position.resize(order.size());
+    forward_legs.resize(order.size());
+    backward_legs.resize(order.size());
+
+    if (limits != nullptr) {
+        load_after.resize(order.size());
+        service_start.resize(order.size());
+        time_slack.resize(order.size());
+    }
+
+    refresh(0, static_cast<int>(order.size()) - 1);
+}
+
+void AnnealingTour::addOrder(int from, int to) {
+    if (std::find(must_follow[from].begin(), must_follow[from].end(), to) == must_follow[from].end()) {
+        must_follow[from].push_back(to);
+        must_precede[to].push_back(from);
+    }
+}
+
+void AnnealingTour::refresh(int lo, int hi) {
+    int num_stops = static_cast<int>(order.size());
+
+    for (int pos = lo; pos <= hi; pos++) {
+        position[order[pos]] = pos;
+    }
+
+    forward_legs[0] = 0;
+    backward_legs[0] = 0;
+    for (int pos = std::max(lo, 1); pos < num_stops; pos++) {
+        forward_legs[pos] = forward_legs[pos - 1] + legCost(nodeAt(pos - 1), nodeAt(pos));
+        backward_legs[pos] = backward_legs[pos - 1] + legCost(nodeAt(pos), nodeAt(pos - 1));
+    }
+
+    // The depot only changes with the first or last stop
+    if (lo == 0 || hi == num_stops - 1) {
+        depot_cost = depotCost(nodeAt(0), nodeAt(num_stops - 1));
+    }
+
+    cost = depot_cost + forward_legs[num_stops - 1];
+
+    if (limits != nullptr) {
+        refreshSchedule(lo);
+    }
+}
+
+void AnnealingTour::refreshSchedule(int lo) {
+    int num_stops = static_cast<int>(order.size());
+
+    for (int pos = lo; pos < num_stops; pos++) {
+        const StopEffect& effect = effects[order[pos]];
+        double arrival = (pos == 0) ? 0 : service_start[pos - 1] + legCost(nodeAt(pos - 1), nodeAt(pos));
+
+        service_start[pos] = std::max(arrival, effect.window.open);
+        load_after[pos] = ((pos == 0) ? 0 : load_after[pos - 1]) + effect.load_change;
+    }
+
+    // A delay at pos is absorbed by the waiting at the next stop before it reaches that stop's slack
+    for (int pos = num_stops - 1; pos >= 0; pos--) {
+        time_slack[pos] = effects[order[pos]].window.close - service_start[pos];
+
+        if (pos < num_stops - 1) {
+            double wait = service_start[pos + 1] - (service_start[pos] + legCost(nodeAt(pos), nodeAt(pos + 1)));
+            time_slack[pos] = std::min(time_slack[pos], wait + time_slack[pos + 1]);
+        }
+    }
+}
+
+bool AnnealingTour::isLegal(const TourMove& move) const {
+    int lo = move.lo();
+    int hi = move.hi();
+
+    if (move.first == move.second) {
+        return true;
+    }
+
+    switch (move.type) {
+        case TourMove::SHIFT: {
+            int block_end = move.first + move.length - 1;
+
+            // Moving later jumps over block_end+1..hi, none of which may have to follow a moved stop
+            if (move.first < move.second) {
+                for (int pos = move.first; pos <= block_end; pos++) {
+                    for (int stop : must_follow[order[pos]]) {
+                        if (position[stop] > block_end && position[stop] <= hi) {
+                            return false;
+                        }
+                    }
+                }
+            }
+            // Moving earlier jumps over lo..first-1, none of which may have to precede a moved stop
+            else {
+                for (int pos = move.first; pos <= block_end; pos++) {
+                    for (int stop : must_precede[order[pos]]) {
+                        if (position[stop] >= lo && position[stop] < move.first) {
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+
+        case TourMove::SWAP:
+            // Only the two swapped stops change order with anything
+            for (int stop : must_follow[order[lo]]) {
+                if (position[stop] <= hi) {
+                    return false;
+                }
+            }
+            for (int stop : must_precede[order[hi]]) {
+                if (position[stop] >= lo) {
+                    return false;
+                }
+            }
+            return true;
+
+        case TourMove::REVERSE:
+            // Any two stops inside the reversed part swap order
+            for (int pos = lo; pos <= hi; pos++) {
+                for (int stop : must_follow[order[pos]]) {
+                    if (position[stop] <= hi) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+
+        default:
+            assert(false);
+            return false;
+    }
+}
+
+double AnnealingTour::costChange(const TourMove& move) const {
+    int lo = move.lo();
+    int hi = move.hi();
+    int last = static_cast<int>(order.size()) - 1;
+
+    if (move.first == move.second) {
+        return 0;
+    }
+
+    double change = 0;
+    int new_first = nodeAt(0);
+    int new_last = nodeAt(last);
+
+    if (move.type == TourMove::SHIFT && move.first < move.second) {
+        // ... p [A..Z] x ... y q ...  ->  ... p x ... y [A..Z] q ...
+        int block_start = nodeAt(lo);
+        int block_end = nodeAt(lo + move.length - 1);
+        int x = nodeAt(lo + move.length);
+        int y = nodeAt(hi);
+
+        if (lo > 0) {
+            change += legCost(nodeAt(lo - 1), x) - legCost(nodeAt(lo - 1), block_start);
+        }
+        change += legCost(y, block_start) - legCost(block_end, x);
+        if (hi < last) {
+            change += legCost(block_end, nodeAt(hi + 1)) - legCost(y, nodeAt(hi + 1));
+        }
+
+        new_first = (lo == 0) ? x : new_first;
+        new_last = (hi == last) ? block_end : new_last;
+    }
+    else if (move.type == TourMove::SHIFT) {
+        // ... p x ... y [A..Z] q ...  ->  ... p [A..Z] x ... y q ...
+        int block_start = nodeAt(move.first);
+        int block_end = nodeAt(hi);
+        int x = nodeAt(lo);
+        int y = nodeAt(move.first - 1);
+
+        if (lo > 0) {
+            change += legCost(nodeAt(lo - 1), block_start) - legCost(nodeAt(lo - 1), x);
+        }
+        change += legCost(block_end, x) - legCost(y, block_start);
+        if (hi < last) {
+            change += legCost(y, nodeAt(hi + 1)) - legCost(block_end, nodeAt(hi + 1));
+        }
+
+        new_first = (lo == 0) ? block_start : new_first;
+        new_last = (hi == last) ? y : new_last;
+    }
+    else {
+        // Swap and reverse both put the stop at hi after lo - 1 and the stop at lo before hi + 1
+        int a = nodeAt(lo);
+        int b = nodeAt(hi);
+        if (lo > 0) {
+            change += legCost(nodeAt(lo - 1), b) - legCost(nodeAt(lo - 1), a);
+        }
+        if (hi < last) {
+            change += legCost(a, nodeAt(hi + 1)) - legCost(b, nodeAt(hi + 1));
+        }
+
+        if (move.type == TourMove::REVERSE) {
+            // The legs in between are driven the other way
+            change += (backward_legs[hi] - backward_legs[lo]) - (forward_legs[hi] - forward_legs[lo]);
+        }
+        else if (hi == lo + 1) {
+            change += legCost(b, a) - legCost(a, b);
+        }
+        else {
+            change += legCost(b, nodeAt(lo + 1)) - legCost(a, nodeAt(lo + 1))
+                    + legCost(nodeAt(hi - 1), a) - legCost(nodeAt(hi - 1), b);
+        }
+
+        new_first = (lo == 0) ? b : new_first;
+        new_last = (hi == last) ? a : new_last;
+    }
+
+    if (new_first != nodeAt(0) || new_last != nodeAt(last)) {
+        change += depotCost(new_first, new_last) - depot_cost;
+    }
+
+    return change;
+}
+
+bool AnnealingTour::meetsLimits(const TourMove& move) const {
+    if (limits == nullptr || move.first == move.second) {
+        return true;
+    }
+
+    int lo = move.lo();
+    int hi = move.hi();
+    int last = static_cast<int>(order.size()) - 1;
+
+    // Replay the positions the move touches from the load and time before them
+    double load = (lo > 0) ? load_after[lo - 1] : 0;
+    double time = (lo > 0) ? service_start[lo - 1] : 0;
+    int previous_node = (lo > 0) ? nodeAt(lo - 1) : -1;
+
+    for (int pos = lo; pos <= hi; pos++) {
+        int stop = stopAfter(move, pos);
+        const StopEffect& effect = effects[stop];
+
+        double arrival = (previous_node == -1) ? 0 : time + legCost(previous_node, stops[stop].node);
+        time = std::max(arrival, effect.window.open);
+        load += effect.load_change;
+
+        if (load > limits->capacity + SCHEDULE_EPSILON || time > effect.window.close + SCHEDULE_EPSILON) {
+            return false;
+        }
+        previous_node = stops[stop].node;
+    }
+
+    // The load after hi is as before, and the rest of the tour can take a delay up to its slack
+    if (hi < last) {
+        double arrival = time + legCost(previous_node, nodeAt(hi + 1));
+        double delay = std::max(arrival, effects[order[hi + 1]].window.open) - service_start[hi + 1];
+        return delay <= time_slack[hi + 1] + SCHEDULE_EPSILON;
+    }
+
+    return true;
+}
+
+bool AnnealingTour::meetsLimits(const std::vector<int>& new_order) const {
+    if (limits == nullptr) {
+        return true;
+    }
+
+    double load = 0;
+    double time = 0;
+    for (size_t pos = 0; pos < new_order.size(); pos++) {
+        const StopEffect& effect = effects[new_order[pos]];
+
+        double arrival = (pos == 0) ? 0 : time + legCost(stops[new_order[pos - 1]].node, stops[new_order[pos]].node);
+        time = std::max(arrival, effect.window.open);
+        load += effect.load_change;
+
+        if (load > limits->capacity + SCHEDULE_EPSILON || time > effect.window.close + SCHEDULE_EPSILON) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int AnnealingTour::stopAfter(const TourMove& move, int pos) const {
+    int lo = move.lo();
+    int hi = move.hi();
+
+    switch (move.type) {
+        case TourMove::SHIFT: {
+            // Later: the stops jumped over come first, then the block
+            if (move.first < move.second) {
+                int num_jumped = hi - lo + 1 - move.length;
+                return (pos - lo < num_jumped) ? order[pos + move.length] : order[pos - num_jumped];
+            }
+            // Earlier: the block comes first, then the stops jumped over
+            return (pos - lo < move.length) ? order[move.first + pos - lo] : order[pos - move.length];
+        }
+
+        case TourMove::SWAP:
+            return (pos == lo) ? order[hi] : (pos == hi) ? order[lo] : order[pos];
+
+        case TourMove::REVERSE:
+            return order[lo + hi - pos];
+
+        default:
+            assert(false);
+            return order[pos];
+    }
+}
+
+void AnnealingTour::apply(const TourMove& move) {
+    int lo = move.lo();
+    int hi = move.hi();
+
+    if (move.first == move.second) {
+        return;
+    }
+
+    switch (move.type) {
+        case TourMove::SHIFT:
+            if (move.first < move.second) {
+                std::rotate(order.begin() + lo, order.begin() + lo + move.length, order.begin() + hi + 1);
+            }
+            else {
+                std::rotate(order.begin() + lo, order.begin() + move.first, order.begin() + hi + 1);
+            }
+            break;
+
+        case TourMove::SWAP:
+            std::swap(order[lo], order[hi]);
+            break;
+
+        case TourMove::REVERSE:
+            std::reverse(order.begin() + lo, order.begin() + hi + 1);
+            break;
+
+        default:
+            assert(false);
+            break;
+    }
+
+    refresh(lo, hi);
+}
+
+std::vector<PickDrop> AnnealingTour::solution(const std::vector<int>& tour_order) const {
+    std::vector<PickDrop> converted_solution;
+    converted_solution.reserve(tour_order.size());
+
+    for (int stop : tour_order) {
+        converted_solution.push_back(stops[stop]);
+    }
+    return converted_solution;
+}
+
+TourMove chooseMove(const AnnealingTour& tour, double temperature, CourierRng& rng) {
+    int n = static_cast<int>(tour.order.size());
+    if (n < 2) {
+        return TourMove(TourMove::SHIFT, 0, 0);
+    }
+
+    int random_value = rng.below(100);
+
+    // Swap two stops, further apart the hotter it is
+    if (random_value < 5 && temperature > 50) {
+        int index1 = rng.below(n);
+        int max_distance = std::max(1, static_cast<int>(n * temperature / 10000));
+        int index2 = (index1 + (rng.below(2 * max_distance + 1) - max_distance) + n) % n; // Wrap around using modulo
+
+        return TourMove(TourMove::SWAP, index1, index2);
+    }
+
+    // Reverse everything from a random stop to the end
+    if (random_value < 25 && temperature > 20) {
+        return TourMove(TourMove::REVERSE, rng.below(n), n - 1);
+    }
+
+    // Shift one stop at most SHIFT_DISTANCE positions
+    int old_index = rng.below(n);
+    int lower_bound = std::max(0, old_index - SHIFT_DISTANCE);
+    int upper_bound = std::min(n - 1, old_index + SHIFT_DISTANCE);
+    int new_index = lower_bound + rng.below(upper_bound - lower_bound + 1);
+
+    // Index after the stop is taken out
+    if (new_index > old_index) {
+        new_index--;
+    }
+
+    return TourMove(TourMove::SHIFT, old_index, new_index);
+}
@@ -0,0 +1,157 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Annealing moves (shift, swap, reverse) on a courier tour. The tour
+ * is held as an order of stop ids with the position of every stop and running
+ * leg costs in both directions, so a move is priced from the matrix entries
+ * around the stops it touches and checked against only those stops' pick up /
+ * drop off constraints. Nothing is copied unless the move is accepted.
+ *
+ * With capacity or time windows, the stop serving each pick up and drop off is
+ * pinned (see AnnealingTour), so a move only changes the load and service times
+ * inside the positions it touches plus a delay pushed down the rest of the tour.
+ * It is checked by replaying those positions against the load before them and
+ * the forward time slack after them.
+ */
+
+#ifndef TOUR_MOVES_H
+#define TOUR_MOVES_H
+
+#include <algorithm>
+#include <vector>
+
+#include "m4_helper.h"
+#include "truck_schedule.h"
+
+// How far a shift may move a stop, in positions
+#define SHIFT_DISTANCE 10
+
+// Length of the nearest neighbour list kept for every stop
+#define NUM_NEIGHBOURS 8
+
+// One perturbation of the tour, given as positions so it can be priced before it is applied
+struct TourMove {
+    enum MoveType {
+        SHIFT = 0,  // Move the length stops from first on so they start at position second (minor perturbation)
+        SWAP,       // Exchange the stops at first and second (moderate perturbation)
+        REVERSE     // Reverse the stops from first to second inclusive (significant perturbation)
+    };
+
+    MoveType type;
+    int first;
+    int second;
+    int length;
+
+    // Constructor for ease of use
+    TourMove(MoveType t, int f, int s, int len = 1)
+        : type(t), first(f), second(s), length(len) {}
+
+    // First and last position whose stop changes
+    int lo() const {
+        return std::min(first, second);
+    }
+
+    int hi() const {
+        return (type == SHIFT) ? std::max(first, second) + length - 1 : std::max(first, second);
+    }
+};
+
+// Tour being annealed over a fixed list of stops
+struct AnnealingTour {
+    const std::vector<PickDrop>& stops;
+    const CourierMatrix& matrix;
+    const DepotTable& depot_table;
+
+    // Stops that have to come before / after each stop (pick ups before their drop offs)
+    std::vector<std::vector<int>> must_precede;
+    std::vector<std::vector<int>> must_follow;
+
+    // The NUM_NEIGHBOURS stops cheapest to drive to from each stop, nearest first
+    std::vector<std::vector<int>> neighbours;
+
+    // Stop id at each position, and position of each stop id
+    std::vector<int> order;
+    std::vector<int> position;
+
+    // Cost of the legs up to each position: forward_legs[p] is 0->1 + ... + (p-1)->p, and
+    // backward_legs[p] the same legs driven the other way (what a reversal would pay)
+    std::vector<double> forward_legs;
+    std::vector<double> backward_legs;
+
+    // Best depot -> first stop + last stop -> depot, and the whole tour including it
+    double depot_cost;
+    double cost;
+
+    // Capacity and time windows, nullptr if the problem has none
+    const ScheduleLimits* limits;
+
+    // Load change and window of each stop
+    std::vector<StopEffect> effects;
+
+    // Load leaving each position, when service there starts, and how much later it could
+    // start without missing a window from there to the end of the tour
+    std::vector<double> load_after;
+    std::vector<double> service_start;
+    std::vector<double> time_slack;
+
+    // Pick ups and drop offs come from schedule_limits, whether or not it has any constraints
+    AnnealingTour(const std::vector<PickDrop>& tour_stops,
+                  const CourierMatrix& courier_matrix,
+                  const DepotTable& depots,
+                  const ScheduleLimits& schedule_limits);
+
+    // Starts over from another order of the same stops (e.g. the best one found so far)
+    void setOrder(const std::vector<int>& new_order);
+
+    // Whether every pick up still happens before its drop offs after the move
+    bool isLegal(const TourMove& move) const;
+
+    // Change in cost the move would make
+    double costChange(const TourMove& move) const;
+
+    // Whether the tour still keeps to the capacity and time windows after a legal move.
+    // Takes time proportional to the positions the move touches, so call it after pricing
+    bool meetsLimits(const TourMove& move) const;
+
+    // The same for a whole new order, from scratch
+    bool meetsLimits(const std::vector<int>& new_order) const;
+
+    // Performs the move in place
+    void apply(const TourMove& move);
+
+    // The stops in the given order, as a solution for PDDToCSP
+    std::vector<PickDrop> solution(const std::vector<int>& tour_order) const;
+
+    int nodeAt(int pos) const {
+        return stops[order[pos]].node;
+    }
+
+    // Matrix cost widened to double, so differences of legs don't round in float
+    double legCost(int from_node, int to_node) const {
+        return matrix.cost(from_node, to_node);
+    }
+
+    // Cheapest round trip from a depot to first_node, and from last_node back to it
+    double depotCost(int first_node, int last_node) const {
+        return depot_table.cost(first_node, last_node);
+    }
+
+    // Stop at pos once the move is made, for lo() <= pos <= hi()
+    int stopAfter(const TourMove& move, int pos) const;
+
+    // Makes from come before to in every tour
+    void addOrder(int from, int to);
+
+    // Recomputes positions of lo..hi and the leg costs from lo on, after those positions changed
+    void refresh(int lo, int hi);
+
+    // Recomputes the load and time profiles from lo on, and the slack of every position
+    void refreshSchedule(int lo);
+};
+
+// Random move for the current temperature: reversals and swaps only while it is still high
+TourMove chooseMove(const AnnealingTour& tour, double temperature, CourierRng& rng);
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Truck load and clock along a tour, see truck_schedule.h
+ */
+
+#include <algorithm>
+
+#include "truck_schedule.h"
+
+ScheduleLimits::ScheduleLimits(const std::vector<DeliveryInf>& courier_deliveries, const CourierConstraints& courier_constraints)
+    : deliveries(courier_deliveries), constraints(courier_constraints) {
+
+    capacity = (constraints.truck_capacity > 0) ? constraints.truck_capacity : DBL_MAX;
+
+    for (int delivery = 0; delivery < static_cast<int>(deliveries.size()); delivery++) {
+        picked_up_at[deliveries[delivery].pickUp].push_back(delivery);
+        dropped_off_at[deliveries[delivery].dropOff].push_back(delivery);
+    }
+}
+
+StopEffect TruckState::effect(IntersectionIdx intersection) const {
+    StopEffect stop_effect;
+
+    auto addWindow = [&](const TimeWindow& window) {
+        stop_effect.window.open = std::max(stop_effect.window.open, window.open);
+        stop_effect.window.close = std::min(stop_effect.window.close, window.close);
+    };
+
+    // Drop offs first, so an item picked up here is only dropped off here if that's its drop off too
+    auto dropped = limits.dropped_off_at.find(intersection);
+    if (dropped != limits.dropped_off_at.end()) {
+        for (int delivery : dropped->second) {
+            if (status[delivery] == ON_BOARD) {
+                stop_effect.load_change -= limits.weight(delivery);
+                addWindow(limits.dropOffWindow(delivery));
+            }
+        }
+    }
+
+    auto picked = limits.picked_up_at.find(intersection);
+    if (picked != limits.picked_up_at.end()) {
+        for (int delivery : picked->second) {
+            if (status[delivery] == WAITING) {
+                addWindow(limits.pickUpWindow(delivery));
+
+                if (limits.deliveries[delivery].dropOff == intersection) {
+                    addWindow(limits.dropOffWindow(delivery));
+                }
+                else {
+                    stop_effect.load_change += limits.weight(delivery);
+                }
+            }
+        }
+    }
+
+    return stop_effect;
+}
+
+double TruckState::serviceStart(IntersectionIdx intersection, double travel_time) const {
+    StopEffect stop_effect = effect(intersection);
+    double start = std::max(started ? time + travel_time : 0.0, stop_effect.window.open);
+
+    if (load + stop_effect.load_change > limits.capacity + SCHEDULE_EPSILON ||
+        start > stop_effect.window.close + SCHEDULE_EPSILON) {
+        return DBL_MAX;
+    }
+    return start;
+}
+
+bool TruckState::visit(IntersectionIdx intersection, double travel_time) {
+    StopEffect stop_effect = effect(intersection);
+    double start = std::max(started ? time + travel_time : 0.0, stop_effect.window.open);
+
+    bool feasible = load + stop_effect.load_change <= limits.capacity + SCHEDULE_EPSILON &&
+                    start <= stop_effect.window.close + SCHEDULE_EPSILON;
+
+    auto dropped = limits.dropped_off_at.find(intersection);
+    if (dropped != limits.dropped_off_at.end()) {
+        for (int delivery : dropped->second) {
+            if (status[delivery] == ON_BOARD) {
+                status[delivery] = DELIVERED;
+            }
+        }
+    }
+
+    auto picked = limits.picked_up_at.find(intersection);
+    if (picked != limits.picked_up_at.end()) {
+        for (int delivery : picked->second) {
+            if (status[delivery] == WAITING) {
+                status[delivery] = (limits.deliveries[delivery].dropOff == intersection) ? DELIVERED : ON_BOARD;
+            }
+        }
+    }
+
+    load += stop_effect.load_change;
+    time = start;
+    started = true;
+
+    return feasible;
+}
+
+void assignStops(const std::vector<IntersectionIdx>& stop_intersections,
+                 const ScheduleLimits& limits,
+                 std::vector<int>& pick_up_stop,
+                 std::vector<int>& drop_off_stop) {
+
+    pick_up_stop.assign(limits.deliveries.size(), -1);
+    drop_off_stop.assign(limits.deliveries.size(), -1);
+
+    for (int stop = 0; stop < static_cast<int>(stop_intersections.size()); stop++) {
+        auto dropped = limits.dropped_off_at.find(stop_intersections[stop]);
+        if (dropped != limits.dropped_off_at.end()) {
+            for (int delivery : dropped->second) {
+                if (pick_up_stop[delivery] != -1 && drop_off_stop[delivery] == -1) {
+                    drop_off_stop[delivery] = stop;
+                }
+            }
+        }
+
+        auto picked = limits.picked_up_at.find(stop_intersections[stop]);
+        if (picked != limits.picked_up_at.end()) {
+            for (int delivery : picked->second) {
+                if (pick_up_stop[delivery] == -1) {
+                    pick_up_stop[delivery] = stop;
+                    if (limits.deliveries[delivery].dropOff == stop_intersections[stop]) {
+                        drop_off_stop[delivery] = stop;
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool meetsConstraints(const std::vector<PickDrop>& solution, const CourierMatrix& matrix, const ScheduleLimits& limits) {
+    TruckState truck(limits);
+
+    for (size_t stop = 0; stop < solution.size(); stop++) {
+        double travel_time = (stop == 0) ? 0 : matrix.cost(solution[stop - 1].node, solution[stop].node);
+        if (!truck.visit(solution[stop].intersection_id, travel_time)) {
+            return false;
+        }
+    }
+
+    return std::all_of(truck.status.begin(), truck.status.end(), [](TruckState::ItemStatus item) {
+        return item == TruckState::DELIVERED;
+    });
+}
@@ -0,0 +1,93 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: Follows the truck's load and clock stop by stop, for building tours
+ * and checking them against the constraints in courier_constraints.h
+ */
+
+#ifndef TRUCK_SCHEDULE_H
+#define TRUCK_SCHEDULE_H
+
+#include "m4_helper.h"
+
+// Slack allowed on capacity and time window checks, so float noise doesn't reject a tour
+#define SCHEDULE_EPSILON 1e-6
+
+// A courier problem's constraints, with the deliveries picked up / dropped off at each intersection
+struct ScheduleLimits {
+    const std::vector<DeliveryInf>& deliveries;
+    const CourierConstraints& constraints;
+
+    // Truck capacity, DBL_MAX for no limit
+    double capacity;
+
+    std::unordered_map<IntersectionIdx, std::vector<int>> picked_up_at;
+    std::unordered_map<IntersectionIdx, std::vector<int>> dropped_off_at;
+
+    ScheduleLimits(const std::vector<DeliveryInf>& courier_deliveries, const CourierConstraints& courier_constraints);
+
+    bool active() const {
+        return !constraints.empty();
+    }
+
+    double weight(int delivery) const {
+        return constraints.deliveries.empty() ? 0 : constraints.deliveries[delivery].item_weight;
+    }
+
+    TimeWindow pickUpWindow(int delivery) const {
+        return constraints.deliveries.empty() ? TimeWindow() : constraints.deliveries[delivery].pick_up;
+    }
+
+    TimeWindow dropOffWindow(int delivery) const {
+        return constraints.deliveries.empty() ? TimeWindow() : constraints.deliveries[delivery].drop_off;
+    }
+};
+
+// What a stop does to the truck: the change in load, and the window shared by everything done there
+struct StopEffect {
+    double load_change = 0;
+    TimeWindow window;
+};
+
+// The truck partway through a tour
+struct TruckState {
+    enum ItemStatus : char {
+        WAITING = 0,
+        ON_BOARD,
+        DELIVERED
+    };
+
+    const ScheduleLimits& limits;
+    std::vector<ItemStatus> status;
+
+    // Weight on board, and when service started at the last stop
+    double load = 0;
+    double time = 0;
+    bool started = false;
+
+    explicit TruckState(const ScheduleLimits& schedule_limits)
+        : limits(schedule_limits), status(schedule_limits.deliveries.size(), WAITING) {}
+
+    // Effect of stopping at the intersection next
+    StopEffect effect(IntersectionIdx intersection) const;
+
+    // When service at the intersection would start after travel_time of driving there (ignored for
+    // the first stop), DBL_MAX if that misses a window or overloads the truck
+    double serviceStart(IntersectionIdx intersection, double travel_time) const;
+
+    // Stops at the intersection, returning false if that breaks a constraint
+    bool visit(IntersectionIdx intersection, double travel_time);
+};
+
+// The stop each delivery is picked up and dropped off at when the stops are visited in order, -1 if none
+void assignStops(const std::vector<IntersectionIdx>& stop_intersections,
+                 const ScheduleLimits& limits,
+                 std::vector<int>& pick_up_stop,
+                 std::vector<int>& drop_off_stop);
+
+// Whether the tour delivers everything within the capacity and the time windows
+bool meetsConstraints(const std::vector<PickDrop>& solution, const CourierMatrix& matrix, const ScheduleLimits& limits);
+
+#endif
@@ -0,0 +1,107 @@
+#include <random>
+#include <vector>
+#include <UnitTest++/UnitTest++.h>
+
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/courier_fleet.h"
+
+#include "courier_test_matrix.h"
+
+using courier_test::FIRST_INTERSECTION;
+
+// Checks how deliveries are split between trucks: every delivery goes to exactly one truck, no
+// truck takes more than it may, and trucks beyond the number of deliveries get nothing.
+
+namespace {
+
+constexpr int NUM_DEPOTS = 2;
+
+// num_deliveries deliveries on their own intersections after the depots
+std::vector<DeliveryInf> separateDeliveries(int num_deliveries) {
+    std::vector<DeliveryInf> deliveries;
+    for (int delivery = 0; delivery < num_deliveries; delivery++) {
+        deliveries.emplace_back(FIRST_INTERSECTION + NUM_DEPOTS + 2 * delivery, FIRST_INTERSECTION + NUM_DEPOTS + 2 * delivery + 1);
+    }
+    return deliveries;
+}
+
+std::vector<IntersectionIdx> testDepots() {
+    std::vector<IntersectionIdx> depots;
+    for (int depot = 0; depot < NUM_DEPOTS; depot++) {
+        depots.push_back(FIRST_INTERSECTION + depot);
+    }
+    return depots;
+}
+
+// One group per truck, every delivery in exactly one of them and no group over max_deliveries
+bool isSplit(const std::vector<std::vector<int>>& groups, int num_deliveries, const FleetOptions& fleet) {
+    if (static_cast<int>(groups.size()) != fleet.num_vehicles) {
+        return false;
+    }
+
+    std::vector<int> times_assigned(num_deliveries, 0);
+    for (const std::vector<int>& group : groups) {
+        if (fleet.max_deliveries > 0 && static_cast<int>(group.size()) > fleet.max_deliveries) {
+            return false;
+        }
+        for (int delivery : group) {
+            if (delivery < 0 || delivery >= num_deliveries) {
+                return false;
+            }
+            times_assigned[delivery]++;
+        }
+    }
+
+    for (int times : times_assigned) {
+        if (times != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+SUITE(courier_fleet) {
+    TEST(split_assigns_every_delivery_once) {
+        std::mt19937 rng(297);
+
+        for (int num_deliveries : {1, 5, 20, 37}) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * num_deliveries, rng);
+            DepotTable depot_table(matrix, testDepots());
+            std::vector<DeliveryInf> deliveries = separateDeliveries(num_deliveries);
+
+            for (int num_vehicles : {1, 2, 3, 8}) {
+                FleetOptions fleet;
+                fleet.num_vehicles = num_vehicles;
+
+                // No limit, then just enough room, then some to spare
+                int just_enough = (num_deliveries + num_vehicles - 1) / num_vehicles;
+                for (int max_deliveries : {0, just_enough, just_enough + 2}) {
+                    fleet.max_deliveries = max_deliveries;
+                    CHECK(isSplit(splitDeliveries(deliveries, matrix, depot_table, fleet), num_deliveries, fleet));
+                }
+            }
+        }
+    } //split_assigns_every_delivery_once
+
+    TEST(split_leaves_extra_trucks_empty) {
+        std::mt19937 rng(336);
+        int num_deliveries = 3;
+
+        CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * num_deliveries, rng);
+        DepotTable depot_table(matrix, testDepots());
+
+        FleetOptions fleet;
+        fleet.num_vehicles = 5;
+        std::vector<std::vector<int>> groups = splitDeliveries(separateDeliveries(num_deliveries), matrix, depot_table, fleet);
+
+        CHECK(isSplit(groups, num_deliveries, fleet));
+
+        // One delivery to each of the first trucks, nothing for the rest
+        for (int vehicle = 0; vehicle < fleet.num_vehicles && vehicle < static_cast<int>(groups.size()); vehicle++) {
+            CHECK(groups[vehicle].size() == (vehicle < num_deliveries ? 1u : 0u));
+        }
+    } //split_leaves_extra_trucks_empty
+
+} //courier_fleet
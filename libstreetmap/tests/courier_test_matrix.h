@@ -0,0 +1,90 @@
+#ifndef COURIER_TEST_MATRIX_H
+#define COURIER_TEST_MATRIX_H
+
+#include <random>
+#include <vector>
+
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/tour_moves.h"
+
+namespace courier_test {
+
+// Intersection of node 0 of a made-up matrix, far from any real map's
+constexpr IntersectionIdx FIRST_INTERSECTION = 1000000;
+
+// Longest block a random shift moves
+constexpr int MAX_SHIFT_LENGTH = 3;
+
+// Cost matrix over num_nodes made-up intersections (node i is FIRST_INTERSECTION + i) with
+// random travel times in both directions and no street segments, for testing the courier
+// solver without a map
+inline CourierMatrix randomCourierMatrix(int num_nodes, std::mt19937& rng) {
+    std::uniform_real_distribution<float> travel_time(1, 100);
+    CourierMatrix matrix;
+
+    for (int node = 0; node < num_nodes; node++) {
+        matrix.intersections.push_back(FIRST_INTERSECTION + node);
+        matrix.node_of[FIRST_INTERSECTION + node] = node;
+    }
+
+    matrix.costs.resize(static_cast<size_t>(num_nodes) * num_nodes);
+    for (int from = 0; from < num_nodes; from++) {
+        for (int to = 0; to < num_nodes; to++) {
+            matrix.costs[static_cast<size_t>(from) * num_nodes + to] = (from == to) ? 0 : travel_time(rng);
+        }
+    }
+
+    matrix.path_offsets.assign(static_cast<size_t>(num_nodes) * num_nodes + 1, 0);
+    return matrix;
+}
+
+// Whether replaying the stops picks up every delivery before dropping it off and drops off all of
+// them. A stop picks up (isPickUp 0 or 2) everything waiting at its intersection, then drops off
+// (isPickUp 1 or 2) everything on the truck for it
+inline bool deliversEverything(const std::vector<DeliveryInf>& deliveries, const std::vector<PickDrop>& tour) {
+    enum ItemStatus { WAITING, ON_TRUCK, DROPPED_OFF };
+    std::vector<ItemStatus> status(deliveries.size(), WAITING);
+
+    for (const PickDrop& stop : tour) {
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (stop.isPickUp != 1 && deliveries[delivery].pickUp == stop.intersection_id && status[delivery] == WAITING) {
+                status[delivery] = ON_TRUCK;
+            }
+        }
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (stop.isPickUp != 0 && deliveries[delivery].dropOff == stop.intersection_id && status[delivery] == ON_TRUCK) {
+                status[delivery] = DROPPED_OFF;
+            }
+        }
+    }
+
+    for (ItemStatus item : status) {
+        if (item != DROPPED_OFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Shift, swap or reversal anywhere in a tour of num_stops stops, legal or not
+inline TourMove randomMove(int num_stops, std::mt19937& rng) {
+    std::uniform_int_distribution<int> position(0, num_stops - 1);
+
+    switch (rng() % 3) {
+        case TourMove::SHIFT: {
+            int length = 1 + rng() % MAX_SHIFT_LENGTH;
+            std::uniform_int_distribution<int> block_start(0, num_stops - length);
+            return TourMove(TourMove::SHIFT, block_start(rng), block_start(rng), length);
+        }
+
+        case TourMove::SWAP:
+            return TourMove(TourMove::SWAP, position(rng), position(rng));
+
+        default:
+            return TourMove(TourMove::REVERSE, position(rng), position(rng));
+    }
+}
+
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <map>
 #include <unordered_set>
+#include <limits>
 #include "StreetsDatabaseAPI.h"
 #include "unit_test_util.h"
 
@@ -701,6 +702,124 @@ double compute_courier_path_travel_time(const std::vector<CourierSubPath>& couri
     return total_travel_time;
 }
 
+bool courier_path_meets_constraints(const std::vector<DeliveryInf>& deliveries,
+                                    const CourierConstraints& constraints,
+                                    const std::vector<CourierSubPath>& path,
+                                    const float turn_penalty) {
+
+    if (constraints.empty()) {
+        return true;
+    }
+
+    if (!constraints.deliveries.empty() && constraints.deliveries.size() != deliveries.size()) {
+        std::cerr << "Invalid courier constraints: " << constraints.deliveries.size()
+                  << " delivery limits for " << deliveries.size() << " deliveries\n";
+        return false;
+    }
+
+    auto item_weight = [&](size_t delivery_idx) {
+        return constraints.deliveries.empty() ? 0.0 : constraints.deliveries[delivery_idx].item_weight;
+    };
+    auto pick_up_window = [&](size_t delivery_idx) {
+        return constraints.deliveries.empty() ? TimeWindow() : constraints.deliveries[delivery_idx].pick_up;
+    };
+    auto drop_off_window = [&](size_t delivery_idx) {
+        return constraints.deliveries.empty() ? TimeWindow() : constraints.deliveries[delivery_idx].drop_off;
+    };
+
+    double capacity = (constraints.truck_capacity > 0) ? constraints.truck_capacity : std::numeric_limits<double>::max();
+
+    enum ItemStatus { WAITING, ON_BOARD, DELIVERED };
+    std::vector<ItemStatus> status(deliveries.size(), WAITING);
+
+    double load = 0.0;
+    double time = 0.0;
+
+    //Pick-ups and drop-offs happen at the start of every subpath after the first,
+    //and the clock starts at the first of them
+    for (size_t sub_idx = 1; sub_idx < path.size(); sub_idx++) {
+        IntersectionIdx stop = getStartIntersection(path[sub_idx]);
+
+        double arrival = 0.0;
+        if (sub_idx > 1) {
+#ifdef PENALTY_FIRST
+            arrival = time + computePathTravelTime(turn_penalty, path[sub_idx - 1].subpath);
+#else
+            arrival = time + computePathTravelTime(path[sub_idx - 1].subpath, turn_penalty);
+#endif
+        }
+
+        //What is dropped off and picked up here
+        std::vector<size_t> dropped;
+        std::vector<size_t> picked;
+        for (size_t delivery_idx = 0; delivery_idx < deliveries.size(); ++delivery_idx) {
+            if (status[delivery_idx] == ON_BOARD && deliveries[delivery_idx].dropOff == stop) {
+                dropped.push_back(delivery_idx);
+            }
+            else if (status[delivery_idx] == WAITING && deliveries[delivery_idx].pickUp == stop) {
+                picked.push_back(delivery_idx);
+            }
+        }
+
+        //The truck waits for the latest window to open
+        double start = arrival;
+        for (size_t delivery_idx : dropped) {
+            start = std::max(start, drop_off_window(delivery_idx).open);
+        }
+        for (size_t delivery_idx : picked) {
+            start = std::max(start, pick_up_window(delivery_idx).open);
+            if (deliveries[delivery_idx].dropOff == stop) {
+                start = std::max(start, drop_off_window(delivery_idx).open);
+            }
+        }
+
+        for (size_t delivery_idx : dropped) {
+            if (start > drop_off_window(delivery_idx).close + FLOAT_EPSILON) {
+                std::cerr << "Invalid courier path: delivery " << delivery_idx << " dropped-off at time " << start
+                          << ", after its window closed at " << drop_off_window(delivery_idx).close << "\n";
+                return false;
+            }
+            status[delivery_idx] = DELIVERED;
+            load -= item_weight(delivery_idx);
+        }
+
+        for (size_t delivery_idx : picked) {
+            if (start > pick_up_window(delivery_idx).close + FLOAT_EPSILON ||
+                (deliveries[delivery_idx].dropOff == stop && start > drop_off_window(delivery_idx).close + FLOAT_EPSILON)) {
+                std::cerr << "Invalid courier path: delivery " << delivery_idx << " picked-up at time " << start
+                          << ", after its window closed\n";
+                return false;
+            }
+
+            if (deliveries[delivery_idx].dropOff == stop) {
+                status[delivery_idx] = DELIVERED;
+            }
+            else {
+                status[delivery_idx] = ON_BOARD;
+                load += item_weight(delivery_idx);
+            }
+        }
+
+        if (load > capacity + FLOAT_EPSILON) {
+            std::cerr << "Invalid courier path: truck carries " << load << " leaving intersection " << stop
+                      << ", over its capacity of " << capacity << "\n";
+            return false;
+        }
+
+        time = start;
+    }
+
+    for (size_t delivery_idx = 0; delivery_idx < deliveries.size(); ++delivery_idx) {
+        if (status[delivery_idx] != DELIVERED) {
+            std::cerr << "Invalid courier path: delivery " << delivery_idx
+                      << " was not picked-up and dropped-off at the start of a subpath\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
 inline IntersectionIdx getStartIntersection(const CourierSubPath &csp) {
 #ifdef PATH_PAIR
     return csp.intersections.first;
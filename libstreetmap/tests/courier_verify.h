@@ -25,6 +25,7 @@
 #include "StreetsDatabaseAPI.h"
 #include "m3.h"
 #include "m4.h"
+#include "courier_constraints.h"
 
 #define FLOAT_EPSILON 3e-2
 
@@ -76,4 +77,12 @@ bool is_end_intersection_correct(const CourierSubPath& cs);
 
 double compute_courier_path_travel_time(const std::vector<CourierSubPath>& courier_route, 
                                         const float turn_penalty);
+
+// Checks a legal courier path against optional item weights, truck capacity and time windows.
+// Items are picked up on the first stop at their pick-up and dropped off on the first stop at
+// their drop-off after that, and the clock starts when the truck reaches its first stop
+bool courier_path_meets_constraints(const std::vector<DeliveryInf>& deliveries,
+                                    const CourierConstraints& constraints,
+                                    const std::vector<CourierSubPath>& path,
+                                    const float turn_penalty);
 }
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <UnitTest++/UnitTest++.h>
+
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/exact_tour.h"
+
+#include "unit_test_util.h"
+#include "courier_test_matrix.h"
+
+using ece297test::relative_error;
+using courier_test::FIRST_INTERSECTION;
+
+// Checks the exact courier tour against trying every order of stops. Deliveries are drawn from a
+// few intersections, so stops are shared, some items are dropped off where they are picked up and
+// some tours have to drive to an intersection twice.
+
+namespace {
+
+constexpr int NUM_DEPOTS = 2;
+
+// Intersections after the depots the deliveries are drawn from
+constexpr int NUM_STOP_NODES = 4;
+
+constexpr int MAX_BRUTE_FORCE_DELIVERIES = 4;
+
+enum ItemStatus { WAITING, ON_TRUCK, DROPPED_OFF };
+
+// Cheapest way to finish every delivery from node at_node and drive back to depot_node, trying
+// every stop where something would happen next
+double cheapestFinish(const std::vector<DeliveryInf>& deliveries,
+                      const CourierMatrix& matrix,
+                      const std::vector<ItemStatus>& status,
+                      int at_node,
+                      int depot_node) {
+
+    if (std::all_of(status.begin(), status.end(), [](ItemStatus item) { return item == DROPPED_OFF; })) {
+        return matrix.cost(at_node, depot_node);
+    }
+
+    double best = DBL_MAX;
+    for (int node = NUM_DEPOTS; node < NUM_DEPOTS + NUM_STOP_NODES; node++) {
+        IntersectionIdx intersection = matrix.intersections[node];
+        std::vector<ItemStatus> next = status;
+
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (deliveries[delivery].pickUp == intersection && next[delivery] == WAITING) {
+                next[delivery] = ON_TRUCK;
+            }
+        }
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (deliveries[delivery].dropOff == intersection && next[delivery] == ON_TRUCK) {
+                next[delivery] = DROPPED_OFF;
+            }
+        }
+
+        if (next != status) {
+            best = std::min(best, matrix.cost(at_node, node) + cheapestFinish(deliveries, matrix, next, node, depot_node));
+        }
+    }
+    return best;
+}
+
+// Cheapest tour over every order of stops and every depot
+double bruteForceTour(const std::vector<DeliveryInf>& deliveries, const CourierMatrix& matrix) {
+    std::vector<ItemStatus> status(deliveries.size(), WAITING);
+
+    double best = DBL_MAX;
+    for (int depot = 0; depot < NUM_DEPOTS; depot++) {
+        best = std::min(best, cheapestFinish(deliveries, matrix, status, depot, depot));
+    }
+    return best;
+}
+
+std::vector<IntersectionIdx> testDepots() {
+    std::vector<IntersectionIdx> depots;
+    for (int depot = 0; depot < NUM_DEPOTS; depot++) {
+        depots.push_back(FIRST_INTERSECTION + depot);
+    }
+    return depots;
+}
+
+IntersectionIdx stopIntersection(int stop) {
+    return FIRST_INTERSECTION + NUM_DEPOTS + stop;
+}
+
+// The exact tour is as cheap as the best order, and is a real tour of the deliveries
+bool matchesBruteForce(const std::vector<DeliveryInf>& deliveries, const CourierMatrix& matrix) {
+    DepotTable depot_table(matrix, testDepots());
+    PathOptions exact = exact_courier_tour(deliveries, matrix, depot_table);
+
+    return relative_error(bruteForceTour(deliveries, matrix), exact.travel_time) < 1e-9 &&
+           relative_error(solution_cost(exact.converted_path, matrix, depot_table), exact.travel_time) < 1e-9 &&
+           courier_test::deliversEverything(deliveries, exact.converted_path);
+}
+
+}
+
+SUITE(exact_tour) {
+    TEST(exact_tour_matches_every_order) {
+        std::mt19937 rng(297);
+        std::uniform_int_distribution<int> stop(0, NUM_STOP_NODES - 1);
+
+        for (int num_deliveries = 1; num_deliveries <= MAX_BRUTE_FORCE_DELIVERIES; num_deliveries++) {
+            for (int instance = 0; instance < 50; instance++) {
+                CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + NUM_STOP_NODES, rng);
+
+                std::vector<DeliveryInf> deliveries;
+                for (int delivery = 0; delivery < num_deliveries; delivery++) {
+                    deliveries.emplace_back(stopIntersection(stop(rng)), stopIntersection(stop(rng)));
+                }
+
+                CHECK(matchesBruteForce(deliveries, matrix));
+            }
+        }
+    } //exact_tour_matches_every_order
+
+    TEST(exact_tour_pick_up_is_drop_off) {
+        std::mt19937 rng(336);
+        CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + NUM_STOP_NODES, rng);
+
+        std::vector<DeliveryInf> deliveries;
+        deliveries.emplace_back(stopIntersection(0), stopIntersection(0));
+        deliveries.emplace_back(stopIntersection(1), stopIntersection(0));
+
+        CHECK(matchesBruteForce(deliveries, matrix));
+
+        // A single stop that picks up and drops off
+        DepotTable depot_table(matrix, testDepots());
+        PathOptions exact = exact_courier_tour({deliveries.front()}, matrix, depot_table);
+        CHECK(exact.converted_path.size() == 1 && exact.converted_path.front().isPickUp == 2);
+    } //exact_tour_pick_up_is_drop_off
+
+    TEST(exact_tour_revisits_intersection) {
+        std::mt19937 rng(412);
+
+        for (int instance = 0; instance < 20; instance++) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + NUM_STOP_NODES, rng);
+            DepotTable depot_table(matrix, testDepots());
+
+            // Each item is picked up where the other is dropped off, so one of the two
+            // intersections has to be driven to twice
+            std::vector<DeliveryInf> deliveries;
+            deliveries.emplace_back(stopIntersection(0), stopIntersection(1));
+            deliveries.emplace_back(stopIntersection(1), stopIntersection(0));
+
+            PathOptions exact = exact_courier_tour(deliveries, matrix, depot_table);
+            CHECK(exact.converted_path.size() == 3);
+            CHECK(matchesBruteForce(deliveries, matrix));
+        }
+    } //exact_tour_revisits_intersection
+
+    TEST(exact_tour_no_deliveries) {
+        std::mt19937 rng(501);
+        CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + NUM_STOP_NODES, rng);
+        DepotTable depot_table(matrix, testDepots());
+
+        PathOptions exact = exact_courier_tour({}, matrix, depot_table);
+        CHECK(exact.path.empty());
+        CHECK(exact.converted_path.empty());
+    } //exact_tour_no_deliveries
+
+} //exact_tour
@@ -0,0 +1,150 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: The searches the kernel replaced, see hand_written_search.h
+ */
+
+#include <list>
+#include <queue>
+
+#include "m1.h"
+#include "m1_helper/m1_globals.h"
+#include "m3_helper/m3_helper.h"
+
+#include "hand_written_search.h"
+
+namespace {
+
+// Node as the hand-written loops used it
+struct HandWrittenNode {
+    bool found = false;
+    std::vector <StreetSegmentIdx> out_edges;
+    StreetSegmentIdx reachingEdge = NO_EDGE;
+    double bestTime = DBL_MAX;
+};
+
+std::vector<StreetSegmentIdx> handWrittenTraceBack(std::vector<HandWrittenNode>& nodes, IntersectionIdx destID) {
+    std::list<StreetSegmentIdx> path;
+    IntersectionIdx currNodeID = destID;
+    StreetSegmentIdx prevEdge = nodes[currNodeID].reachingEdge;
+
+    while (prevEdge != NO_EDGE) {
+        path.push_front(prevEdge);
+        currNodeID = (currNodeID == get_street_seg_from(prevEdge)) ? get_street_seg_to(prevEdge) : get_street_seg_from(prevEdge);
+        prevEdge = nodes[currNodeID].reachingEdge;
+    }
+
+    return {std::begin(path), std::end(path)};
+}
+
+}
+
+// The original bfsPath A*
+std::vector<StreetSegmentIdx> handWrittenRoute(const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty) {
+    std::vector<HandWrittenNode> nodes(getNumIntersections());
+
+    std::priority_queue<WaveElem, std::vector<WaveElem>, std::greater<WaveElem>> wavefront;
+    wavefront.push(WaveElem(srcID, NO_EDGE, 0, 0));
+    bool pathFound = false;
+
+    while (wavefront.size() > 0) {
+        WaveElem curr = wavefront.top();
+        wavefront.pop();
+
+        if (curr.travelTime < nodes[curr.nodeID].bestTime && curr.travelTime < nodes[destID].bestTime) {
+            nodes[curr.nodeID].reachingEdge = curr.edgeID;
+            nodes[curr.nodeID].bestTime = curr.travelTime;
+
+            if (curr.nodeID == destID) {
+                pathFound = true;
+            }
+            else {
+                nodes[curr.nodeID].out_edges = findStreetSegmentsOfIntersection(curr.nodeID);
+
+                for (StreetSegmentIdx out_edge : nodes[curr.nodeID].out_edges) {
+                    int toNodeID = 0;
+                    if (curr.nodeID == get_street_seg_from(out_edge)) {
+                        toNodeID = get_street_seg_to(out_edge);
+                    }
+                    else if (!get_street_seg_one_way(out_edge) && (curr.nodeID == get_street_seg_to(out_edge))) {
+                        toNodeID = get_street_seg_from(out_edge);
+                    }
+                    else {
+                        continue;
+                    }
+
+                    double travelTime;
+                    if (nodes[curr.nodeID].reachingEdge != NO_EDGE && get_street_seg_street_id(nodes[curr.nodeID].reachingEdge) != get_street_seg_street_id(out_edge)) {
+                        travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge) + turn_penalty;
+                    }
+                    else {
+                        travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge);
+                    }
+
+                    if (travelTime < nodes[toNodeID].bestTime) {
+                        double heuristic = findDistanceBetweenTwoPoints(get_intersection_position(toNodeID), get_intersection_position(destID)) / get_max_speed();
+                        wavefront.push(WaveElem(toNodeID, out_edge, travelTime, heuristic));
+                    }
+                }
+            }
+        }
+    }
+
+    if (!pathFound) {
+        return {};
+    }
+    return handWrittenTraceBack(nodes, destID);
+}
+
+// The original courier matrix Dijkstra (one source to every destination)
+std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> handWrittenAllPaths(const IntersectionIdx srcID, const std::vector<IntersectionIdx>& destIDs, const double turn_penalty) {
+    std::vector<HandWrittenNode> nodes(getNumIntersections());
+
+    std::priority_queue<WaveElem, std::vector<WaveElem>, std::greater<WaveElem>> wavefront;
+    wavefront.push(WaveElem(srcID, NO_EDGE, 0, 0));
+
+    while (wavefront.size() > 0) {
+        WaveElem curr = wavefront.top();
+        wavefront.pop();
+
+        if (curr.travelTime < nodes[curr.nodeID].bestTime) {
+            nodes[curr.nodeID].reachingEdge = curr.edgeID;
+            nodes[curr.nodeID].bestTime = curr.travelTime;
+            nodes[curr.nodeID].found = true;
+            nodes[curr.nodeID].out_edges = findStreetSegmentsOfIntersection(curr.nodeID);
+
+            for (StreetSegmentIdx out_edge : nodes[curr.nodeID].out_edges) {
+                int toNodeID = 0;
+                if (curr.nodeID == get_street_seg_from(out_edge)) {
+                    toNodeID = get_street_seg_to(out_edge);
+                }
+                else if (!get_street_seg_one_way(out_edge) && (curr.nodeID == get_street_seg_to(out_edge))) {
+                    toNodeID = get_street_seg_from(out_edge);
+                }
+                else {
+                    continue;
+                }
+
+                double travelTime;
+                if (nodes[curr.nodeID].reachingEdge != NO_EDGE && get_street_seg_street_id(nodes[curr.nodeID].reachingEdge) != get_street_seg_street_id(out_edge)) {
+                    travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge) + turn_penalty;
+                }
+                else {
+                    travelTime = nodes[curr.nodeID].bestTime + findStreetSegmentTravelTime(out_edge);
+                }
+
+                if (travelTime < nodes[toNodeID].bestTime) {
+                    wavefront.push(WaveElem(toNodeID, out_edge, travelTime, 0));
+                }
+            }
+        }
+    }
+
+    std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> all_paths;
+    for (IntersectionIdx dest_id : destIDs) {
+        all_paths[dest_id] = handWrittenTraceBack(nodes, dest_id);
+    }
+    return all_paths;
+}
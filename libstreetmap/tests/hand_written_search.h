@@ -0,0 +1,26 @@
+/*
+ * Authors: Michael Harhay, Phoebe Owusu, Vanessa Poiana
+ *
+ * Date: 18/10/2026
+ *
+ * Description: The hand-written route and courier matrix searches the templated search
+ * kernel replaced, copied unchanged apart from taking their node vector locally. The
+ * kernel is checked against them (search_kernel_test.cpp) and timed against them
+ * (courier_bench --routes).
+ */
+
+#ifndef HAND_WRITTEN_SEARCH_H
+#define HAND_WRITTEN_SEARCH_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "StreetsDatabaseAPI.h"
+
+// The original bfsPath A*
+std::vector<StreetSegmentIdx> handWrittenRoute(const IntersectionIdx srcID, const IntersectionIdx destID, const double turn_penalty);
+
+// The original courier matrix Dijkstra (one source to every destination)
+std::unordered_map<IntersectionIdx, std::vector<StreetSegmentIdx>> handWrittenAllPaths(const IntersectionIdx srcID, const std::vector<IntersectionIdx>& destIDs, const double turn_penalty);
+
+#endif
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <random>
+#include <UnitTest++/UnitTest++.h>
+
+#include "StreetsDatabaseAPI.h"
+#include "m1.h"
+#include "m3.h"
+#include "m4_helper/m4_helper.h"
+
+#include "unit_test_util.h"
+#include "hand_written_search.h"
+
+using ece297test::relative_error;
+
+// Checks the templated search kernel against the hand-written loops it replaced
+// (see hand_written_search.h). Both must find equally fast paths. courier_bench
+// --routes times the two against each other.
+
+SUITE(search_kernel) {
+    TEST(route_kernel_vs_hand_written) {
+        std::mt19937 rng(297);
+        std::uniform_int_distribution<IntersectionIdx> intersection_dist(0, getNumIntersections() - 1);
+
+        std::vector<std::pair<IntersectionIdx, IntersectionIdx>> queries;
+        for (int query = 0; query < 200; query++) {
+            queries.push_back({intersection_dist(rng), intersection_dist(rng)});
+        }
+
+        for (double turn_penalty : {0.0, 15.0}) {
+            std::vector<double> hand_written_times, kernel_times;
+
+            for (const auto& query : queries) {
+                hand_written_times.push_back(computePathTravelTime(turn_penalty, handWrittenRoute(query.first, query.second, turn_penalty)));
+                kernel_times.push_back(computePathTravelTime(turn_penalty, findPathBetweenIntersections(turn_penalty, query)));
+            }
+
+            for (size_t query = 0; query < queries.size(); query++) {
+                CHECK(relative_error(hand_written_times[query], kernel_times[query]) < 1e-9);
+            }
+        }
+    } //route_kernel_vs_hand_written
+
+    TEST(matrix_kernel_vs_hand_written) {
+        std::mt19937 rng(297);
+        std::uniform_int_distribution<IntersectionIdx> intersection_dist(0, getNumIntersections() - 1);
+
+        std::vector<IntersectionIdx> interesting;
+        for (int idx = 0; idx < 40; idx++) {
+            interesting.push_back(intersection_dist(rng));
+        }
+        std::sort(interesting.begin(), interesting.end());
+        interesting.erase(std::unique(interesting.begin(), interesting.end()), interesting.end());
+
+        // Every intersection both a pick up and a drop off, so every pair of the matrix is searched
+        std::vector<DeliveryInf> deliveries;
+        for (size_t idx = 0; idx < interesting.size(); idx++) {
+            deliveries.emplace_back(interesting[idx], interesting[(idx + 1) % interesting.size()]);
+        }
+
+        for (double turn_penalty : {0.0, 15.0}) {
+            double hand_written_total = 0, kernel_total = 0;
+
+            for (IntersectionIdx src : interesting) {
+                for (const auto& dest_path : handWrittenAllPaths(src, interesting, turn_penalty)) {
+                    hand_written_total += computePathTravelTime(turn_penalty, dest_path.second);
+                }
+            }
+
+            CourierMatrix matrix = computeCourierMatrix(deliveries, {}, turn_penalty);
+            for (int from = 0; from < matrix.size(); from++) {
+                for (int to = 0; to < matrix.size(); to++) {
+                    kernel_total += computePathTravelTime(turn_penalty, matrix.path(from, to));
+                }
+            }
+
+            CHECK(relative_error(hand_written_total, kernel_total) < 1e-9);
+        }
+    } //matrix_kernel_vs_hand_written
+
+} //search_kernel
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include <float.h>
+#include <UnitTest++/UnitTest++.h>
+
+#include "StreetsDatabaseAPI.h"
+#include "m1.h"
+#include "m3.h"
+#include "m3_helper/travel_profiles.h"
+#include "m3_helper/snap_to_road.h"
+
+#include "unit_test_util.h"
+
+using ece297test::relative_error;
+
+// Checks routing between snapped positions: from one intersection to another it has to be as
+// fast as the intersection route, and from part way along a segment as fast as trying every way
+// off the start segment and onto the end one. The segments have to join up and only include
+// ones the route drives.
+
+namespace {
+
+constexpr int NUM_ROUTES = 150;
+
+// Most a mid-segment position is placed from a random intersection, in degrees
+constexpr double MAX_OFFSET = 0.002;
+
+// Intersections next to a snapped position and the time to drive between each and the position,
+// leaving it when leaving is true and arriving at it otherwise. A position right at an
+// intersection takes no time to reach, whichever way its segment goes
+std::vector<std::pair<IntersectionIdx, double>> segmentEnds(const SnappedPoint& point, bool leaving) {
+    const ProfileGraph& graph = get_profile_graph(DRIVING);
+    double towards_to = leaving ? graph.forward_time[point.segment] : graph.backward_time[point.segment];
+    double towards_from = leaving ? graph.backward_time[point.segment] : graph.forward_time[point.segment];
+
+    std::vector<std::pair<IntersectionIdx, double>> ends;
+    if (point.fraction == 1) {
+        ends.push_back({getStreetSegmentInfo(point.segment).to, 0});
+    }
+    else if (towards_to != NO_ACCESS) {
+        ends.push_back({getStreetSegmentInfo(point.segment).to, (1 - point.fraction) * towards_to});
+    }
+    if (point.fraction == 0) {
+        ends.push_back({getStreetSegmentInfo(point.segment).from, 0});
+    }
+    else if (towards_from != NO_ACCESS) {
+        ends.push_back({getStreetSegmentInfo(point.segment).from, point.fraction * towards_from});
+    }
+    return ends;
+}
+
+// Fastest route without turn penalties, over every way off the start segment, every
+// intersection route and every way onto the end segment. DBL_MAX if there is none
+double bruteForceTime(const SnappedPoint& start, const SnappedPoint& end) {
+    const ProfileGraph& graph = get_profile_graph(DRIVING);
+    double best = DBL_MAX;
+
+    // Straight along a shared segment
+    if (start.segment == end.segment) {
+        if (end.fraction >= start.fraction && graph.forward_time[start.segment] != NO_ACCESS) {
+            best = (end.fraction - start.fraction) * graph.forward_time[start.segment];
+        }
+        if (end.fraction <= start.fraction && graph.backward_time[start.segment] != NO_ACCESS) {
+            best = std::min(best, (start.fraction - end.fraction) * graph.backward_time[start.segment]);
+        }
+    }
+
+    for (const std::pair<IntersectionIdx, double>& leave : segmentEnds(start, true)) {
+        for (const std::pair<IntersectionIdx, double>& arrive : segmentEnds(end, false)) {
+            double between = 0;
+            if (leave.first != arrive.first) {
+                std::vector<StreetSegmentIdx> route = findPathBetweenIntersections(0, {leave.first, arrive.first});
+                if (route.empty()) {
+                    continue;
+                }
+                between = computePathTravelTime(0, route);
+            }
+            best = std::min(best, leave.second + between + arrive.second);
+        }
+    }
+    return best;
+}
+
+// Whether the snapped position is intersection itself
+bool isAtIntersection(const SnappedPoint& point, IntersectionIdx intersection) {
+    StreetSegmentInfo info = getStreetSegmentInfo(point.segment);
+    return (point.fraction == 0 && info.from == intersection) || (point.fraction == 1 && info.to == intersection);
+}
+
+// Every segment shares an intersection with the next, and the first / last is the snapped
+// segment unless the position is right at an intersection
+bool isConnected(const PositionPath& path) {
+    for (size_t idx = 1; idx < path.segments.size(); idx++) {
+        StreetSegmentInfo prev = getStreetSegmentInfo(path.segments[idx - 1]);
+        StreetSegmentInfo next = getStreetSegmentInfo(path.segments[idx]);
+        if (prev.from != next.from && prev.from != next.to && prev.to != next.from && prev.to != next.to) {
+            return false;
+        }
+    }
+
+    bool starts_on_segment = path.segments.front() == path.start.segment;
+    bool ends_on_segment = path.segments.back() == path.end.segment;
+    return (starts_on_segment || path.start.fraction == 0 || path.start.fraction == 1) &&
+           (ends_on_segment || path.end.fraction == 0 || path.end.fraction == 1);
+}
+
+}
+
+SUITE(snap_to_road) {
+    TEST(intersection_positions_match_intersection_route) {
+        std::mt19937 rng(297);
+        std::uniform_int_distribution<IntersectionIdx> random_intersection(0, getNumIntersections() - 1);
+
+        int num_checked = 0;
+
+        for (double turn_penalty : {0.0, 15.0}) {
+            for (int route_num = 0; route_num < NUM_ROUTES; route_num++) {
+                IntersectionIdx src = random_intersection(rng);
+                IntersectionIdx dest = random_intersection(rng);
+
+                PositionPath path = findPathBetweenPositions(turn_penalty, {getIntersectionPosition(src), getIntersectionPosition(dest)});
+
+                // Intersections the profile can't drive to snap onto some other segment
+                if (src == dest || path.start.segment == -1 || path.end.segment == -1 ||
+                    !isAtIntersection(path.start, src) || !isAtIntersection(path.end, dest)) {
+                    continue;
+                }
+                num_checked++;
+
+                std::vector<StreetSegmentIdx> route = findPathBetweenIntersections(turn_penalty, {src, dest});
+                if (route.empty()) {
+                    CHECK(path.segments.empty());
+                    CHECK(path.travel_time == DBL_MAX);
+                    continue;
+                }
+
+                // Only whole segments are driven, so the segments alone give the travel time
+                CHECK(relative_error(computePathTravelTime(turn_penalty, route), path.travel_time) < 1e-9);
+                CHECK(!path.segments.empty() && isConnected(path));
+                CHECK(relative_error(computePathTravelTime(turn_penalty, path.segments), path.travel_time) < 1e-9);
+            }
+        }
+
+        CHECK(num_checked > NUM_ROUTES);
+    } //intersection_positions_match_intersection_route
+
+    TEST(mid_segment_positions_match_brute_force) {
+        std::mt19937 rng(336);
+        std::uniform_int_distribution<IntersectionIdx> random_intersection(0, getNumIntersections() - 1);
+        std::uniform_real_distribution<double> offset(-MAX_OFFSET, MAX_OFFSET);
+
+        auto randomPosition = [&]() {
+            LatLon near = getIntersectionPosition(random_intersection(rng));
+            return LatLon(near.latitude() + offset(rng), near.longitude() + offset(rng));
+        };
+
+        int num_found = 0;
+
+        for (int route_num = 0; route_num < 2 * NUM_ROUTES; route_num++) {
+            PositionPath path = findPathBetweenPositions(0, {randomPosition(), randomPosition()});
+            if (path.start.segment == -1 || path.end.segment == -1) {
+                continue;
+            }
+
+            double expected_time = bruteForceTime(path.start, path.end);
+            if (expected_time == DBL_MAX) {
+                CHECK(path.segments.empty());
+                CHECK(path.travel_time == DBL_MAX);
+                continue;
+            }
+            num_found++;
+
+            CHECK(relative_error(expected_time, path.travel_time) < 1e-9);
+            CHECK(!path.segments.empty() && isConnected(path));
+        }
+
+        CHECK(num_found > NUM_ROUTES);
+    } //mid_segment_positions_match_brute_force
+
+} //snap_to_road
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <UnitTest++/UnitTest++.h>
+
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/tour_moves.h"
+#include "m4_helper/local_search.h"
+
+#include "unit_test_util.h"
+#include "courier_test_matrix.h"
+
+using ece297test::relative_error;
+using courier_test::FIRST_INTERSECTION;
+
+// Checks the O(1) pricing of annealing moves: after every legal shift, swap and reversal applied
+// to a tour over a made-up matrix, the running cost has to be what costChange said it would be
+// and what solution_cost gets from scratch, and every item still has to be picked up first.
+// The same for relocating a pick up and drop off pair, and for a whole local search.
+
+namespace {
+
+constexpr int NUM_DEPOTS = 2;
+constexpr int NUM_PAIRS = 6;
+constexpr int NUM_MOVES = 5000;
+
+// Deliveries over the matrix nodes after the depots: NUM_PAIRS on their own intersections, one
+// picked up where the first pair is dropped off and one picked up with the first pair
+std::vector<DeliveryInf> sharedDeliveries() {
+    auto intersection = [](int node) { return FIRST_INTERSECTION + node; };
+    int first_free = NUM_DEPOTS + 2 * NUM_PAIRS;
+
+    std::vector<DeliveryInf> deliveries;
+    for (int pair = 0; pair < NUM_PAIRS; pair++) {
+        deliveries.emplace_back(intersection(NUM_DEPOTS + 2 * pair), intersection(NUM_DEPOTS + 2 * pair + 1));
+    }
+    deliveries.emplace_back(intersection(NUM_DEPOTS + 1), intersection(first_free));
+    deliveries.emplace_back(intersection(NUM_DEPOTS), intersection(first_free + 1));
+    return deliveries;
+}
+
+// A legal tour of sharedDeliveries: pick ups, then the stop that drops off and picks up, then
+// drop offs, each group in random order
+std::vector<PickDrop> startingTour(std::mt19937& rng) {
+    std::vector<PickDrop> pick_ups;
+    std::vector<PickDrop> drop_offs;
+
+    for (int pair = 0; pair < NUM_PAIRS; pair++) {
+        int pick_up_node = NUM_DEPOTS + 2 * pair;
+        pick_ups.push_back({0, FIRST_INTERSECTION + pick_up_node, pick_up_node});
+
+        if (pair > 0) {
+            drop_offs.push_back({1, FIRST_INTERSECTION + pick_up_node + 1, pick_up_node + 1});
+        }
+    }
+
+    int first_free = NUM_DEPOTS + 2 * NUM_PAIRS;
+    drop_offs.push_back({1, FIRST_INTERSECTION + first_free, first_free});
+    drop_offs.push_back({1, FIRST_INTERSECTION + first_free + 1, first_free + 1});
+
+    std::shuffle(pick_ups.begin(), pick_ups.end(), rng);
+    std::shuffle(drop_offs.begin(), drop_offs.end(), rng);
+
+    std::vector<PickDrop> tour = pick_ups;
+    tour.push_back({2, FIRST_INTERSECTION + NUM_DEPOTS + 1, NUM_DEPOTS + 1});
+    tour.insert(tour.end(), drop_offs.begin(), drop_offs.end());
+    return tour;
+}
+
+// The depots before any other node of the matrix
+std::vector<IntersectionIdx> testDepots() {
+    std::vector<IntersectionIdx> depots;
+    for (int depot = 0; depot < NUM_DEPOTS; depot++) {
+        depots.push_back(FIRST_INTERSECTION + depot);
+    }
+    return depots;
+}
+
+// Applies up to num_moves random legal moves, to start from a different tour
+void shuffleTour(AnnealingTour& tour, int num_moves, std::mt19937& rng) {
+    for (int move_num = 0; move_num < num_moves; move_num++) {
+        TourMove move = courier_test::randomMove(static_cast<int>(tour.order.size()), rng);
+        if (tour.isLegal(move)) {
+            tour.apply(move);
+        }
+    }
+}
+
+// Whether every stop in the order comes before the stops that must follow it
+bool keepsPrecedence(const AnnealingTour& tour, const std::vector<int>& order) {
+    std::vector<int> position(order.size());
+    for (size_t pos = 0; pos < order.size(); pos++) {
+        position[order[pos]] = static_cast<int>(pos);
+    }
+
+    for (size_t stop = 0; stop < order.size(); stop++) {
+        for (int later : tour.must_follow[stop]) {
+            if (position[stop] > position[later]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+SUITE(tour_moves) {
+    TEST(cost_change_matches_solution_cost) {
+        std::mt19937 rng(297);
+
+        std::vector<DeliveryInf> deliveries = sharedDeliveries();
+        CourierConstraints no_constraints;
+        ScheduleLimits limits(deliveries, no_constraints);
+
+        std::vector<IntersectionIdx> depots = testDepots();
+
+        int applied[3] = {0, 0, 0};
+
+        for (int instance = 0; instance < 10; instance++) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * NUM_PAIRS + 2, rng);
+            DepotTable depot_table(matrix, depots);
+
+            std::vector<PickDrop> stops = startingTour(rng);
+            AnnealingTour tour(stops, matrix, depot_table, limits);
+            CHECK(relative_error(solution_cost(stops, matrix, depot_table), tour.cost) < 1e-9);
+
+            for (int move_num = 0; move_num < NUM_MOVES; move_num++) {
+                TourMove move = courier_test::randomMove(static_cast<int>(stops.size()), rng);
+                if (!tour.isLegal(move)) {
+                    continue;
+                }
+
+                double expected_cost = tour.cost + tour.costChange(move);
+                tour.apply(move);
+                applied[move.type]++;
+
+                std::vector<PickDrop> solution = tour.solution(tour.order);
+                CHECK(relative_error(expected_cost, tour.cost) < 1e-9);
+                CHECK(relative_error(solution_cost(solution, matrix, depot_table), tour.cost) < 1e-9);
+                CHECK(courier_test::deliversEverything(deliveries, solution));
+            }
+        }
+
+        // Every kind of move got tried
+        CHECK(applied[TourMove::SHIFT] > 0);
+        CHECK(applied[TourMove::SWAP] > 0);
+        CHECK(applied[TourMove::REVERSE] > 0);
+    } //cost_change_matches_solution_cost
+
+    TEST(relocate_pair_change_matches_solution_cost) {
+        std::mt19937 rng(336);
+
+        std::vector<DeliveryInf> deliveries = sharedDeliveries();
+        CourierConstraints no_constraints;
+        ScheduleLimits limits(deliveries, no_constraints);
+
+        int num_relocations = 0;
+
+        for (int instance = 0; instance < 20; instance++) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * NUM_PAIRS + 2, rng);
+            DepotTable depot_table(matrix, testDepots());
+
+            std::vector<PickDrop> stops = startingTour(rng);
+            AnnealingTour tour(stops, matrix, depot_table, limits);
+            shuffleTour(tour, 200, rng);
+
+            int num_stops = static_cast<int>(stops.size());
+
+            // Every pair, put back before every stop (or the drop off at the very end), wherever
+            // the drop off still comes after the pick up and nothing else goes out of order
+            for (int pick_up = 0; pick_up < num_stops; pick_up++) {
+                for (int drop_off : tour.must_follow[pick_up]) {
+                    for (int pick_up_before = 0; pick_up_before < num_stops; pick_up_before++) {
+                        for (int drop_off_before = END_OF_TOUR; drop_off_before < num_stops; drop_off_before++) {
+                            if (pick_up_before == pick_up || pick_up_before == drop_off ||
+                                drop_off_before == pick_up || drop_off_before == drop_off) {
+                                continue;
+                            }
+                            if (drop_off_before != END_OF_TOUR && tour.position[drop_off_before] < tour.position[pick_up_before]) {
+                                continue;
+                            }
+
+                            AnnealingTour relocated = tour;
+                            CHECK(relocatePair(relocated, pick_up, drop_off, pick_up_before, drop_off_before));
+                            if (!keepsPrecedence(tour, relocated.order)) {
+                                continue;
+                            }
+
+                            double expected_cost = tour.cost + relocatePairChange(tour, pick_up, drop_off, pick_up_before, drop_off_before);
+                            std::vector<PickDrop> solution = relocated.solution(relocated.order);
+                            CHECK(relative_error(solution_cost(solution, matrix, depot_table), expected_cost) < 1e-9);
+                            CHECK(courier_test::deliversEverything(deliveries, solution));
+                            num_relocations++;
+                        }
+                    }
+                }
+            }
+        }
+
+        CHECK(num_relocations > 1000);
+    } //relocate_pair_change_matches_solution_cost
+
+    TEST(local_search_never_raises_cost) {
+        std::mt19937 rng(412);
+
+        std::vector<DeliveryInf> deliveries = sharedDeliveries();
+        CourierConstraints no_constraints;
+        ScheduleLimits limits(deliveries, no_constraints);
+
+        for (int instance = 0; instance < 50; instance++) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * NUM_PAIRS + 2, rng);
+            DepotTable depot_table(matrix, testDepots());
+
+            std::vector<PickDrop> stops = startingTour(rng);
+            AnnealingTour tour(stops, matrix, depot_table, limits);
+            shuffleTour(tour, 200, rng);
+
+            double cost_before = tour.cost;
+            localSearch(tour);
+
+            std::vector<PickDrop> solution = tour.solution(tour.order);
+            CHECK(tour.cost <= cost_before + 1e-9);
+            CHECK(relative_error(solution_cost(solution, matrix, depot_table), tour.cost) < 1e-9);
+            CHECK(courier_test::deliversEverything(deliveries, solution));
+        }
+    } //local_search_never_raises_cost
+
+} //tour_moves
@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include <UnitTest++/UnitTest++.h>
+
+#include "m1.h"
+#include "m4.h"
+#include "m3_helper/travel_profiles.h"
+#include "m4_helper/m4_helper.h"
+#include "m4_helper/tour_moves.h"
+#include "m4_helper/truck_schedule.h"
+
+#include "unit_test_util.h"
+#include "courier_verify.h"
+#include "courier_test_matrix.h"
+
+using courier_test::FIRST_INTERSECTION;
+
+// Checks the capacity and time window bookkeeping: the incremental check of a move against the
+// load and slack profiles has to agree with replaying the whole moved tour, and a constrained
+// route from the solver has to pass the verifier's own replay.
+
+namespace {
+
+constexpr int NUM_DEPOTS = 2;
+constexpr int NUM_PAIRS = 7;
+constexpr int NUM_MOVES = 4000;
+
+// Most a window opens before / closes after the time the starting tour serves it
+constexpr double MAX_WINDOW_SLACK = 120;
+
+// Deliveries on their own intersections after the depots, plus one more picked up with the first
+std::vector<DeliveryInf> pairedDeliveries() {
+    std::vector<DeliveryInf> deliveries;
+    for (int pair = 0; pair < NUM_PAIRS; pair++) {
+        deliveries.emplace_back(FIRST_INTERSECTION + NUM_DEPOTS + 2 * pair, FIRST_INTERSECTION + NUM_DEPOTS + 2 * pair + 1);
+    }
+    deliveries.emplace_back(FIRST_INTERSECTION + NUM_DEPOTS, FIRST_INTERSECTION + NUM_DEPOTS + 2 * NUM_PAIRS);
+    return deliveries;
+}
+
+// A random tour of pairedDeliveries with every drop off after its pick up, one stop per intersection
+std::vector<PickDrop> randomLegalTour(const std::vector<DeliveryInf>& deliveries, std::mt19937& rng) {
+    std::vector<int> pick_up_node(deliveries.size());
+    std::vector<bool> picked_up(deliveries.size(), false);
+    std::vector<PickDrop> waiting;
+
+    for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+        pick_up_node[delivery] = deliveries[delivery].pickUp - FIRST_INTERSECTION;
+        int drop_off_node = deliveries[delivery].dropOff - FIRST_INTERSECTION;
+        waiting.push_back({1, deliveries[delivery].dropOff, drop_off_node});
+
+        if (std::none_of(waiting.begin(), waiting.end(), [&](const PickDrop& stop) { return stop.node == pick_up_node[delivery]; })) {
+            waiting.push_back({0, deliveries[delivery].pickUp, pick_up_node[delivery]});
+        }
+    }
+
+    // Any pick up, or a drop off whose item is on the truck
+    std::vector<PickDrop> tour;
+    while (!waiting.empty()) {
+        std::vector<int> ready;
+        for (int stop = 0; stop < static_cast<int>(waiting.size()); stop++) {
+            if (waiting[stop].isPickUp == 0) {
+                ready.push_back(stop);
+                continue;
+            }
+            for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+                if (deliveries[delivery].dropOff == waiting[stop].intersection_id && picked_up[delivery]) {
+                    ready.push_back(stop);
+                }
+            }
+        }
+
+        int next = ready[rng() % ready.size()];
+        if (waiting[next].isPickUp == 0) {
+            for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+                picked_up[delivery] = picked_up[delivery] || pick_up_node[delivery] == waiting[next].node;
+            }
+        }
+        tour.push_back(waiting[next]);
+        waiting.erase(waiting.begin() + next);
+    }
+    return tour;
+}
+
+// Weights, a capacity and windows the tour just keeps to: every window holds the time the tour
+// serves it, give or take up to MAX_WINDOW_SLACK, and the capacity is a little over its heaviest load
+CourierConstraints constraintsAround(const std::vector<DeliveryInf>& deliveries,
+                                     const std::vector<PickDrop>& tour,
+                                     const CourierMatrix& matrix,
+                                     std::mt19937& rng) {
+    std::uniform_real_distribution<double> weight(1, 10);
+    std::uniform_real_distribution<double> slack(0, MAX_WINDOW_SLACK);
+    std::uniform_real_distribution<double> spare_capacity(1, 1.2);
+
+    CourierConstraints constraints;
+    constraints.deliveries.resize(deliveries.size());
+    for (DeliveryLimits& limits : constraints.deliveries) {
+        limits.item_weight = weight(rng);
+    }
+
+    std::unordered_map<IntersectionIdx, double> service_time;
+    double time = 0;
+    double load = 0;
+    double heaviest = 0;
+    for (size_t stop = 0; stop < tour.size(); stop++) {
+        time += (stop == 0) ? 0 : matrix.cost(tour[stop - 1].node, tour[stop].node);
+        service_time[tour[stop].intersection_id] = time;
+
+        for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+            if (deliveries[delivery].pickUp == tour[stop].intersection_id) {
+                load += constraints.deliveries[delivery].item_weight;
+            }
+            if (deliveries[delivery].dropOff == tour[stop].intersection_id) {
+                load -= constraints.deliveries[delivery].item_weight;
+            }
+        }
+        heaviest = std::max(heaviest, load);
+    }
+
+    for (size_t delivery = 0; delivery < deliveries.size(); delivery++) {
+        double pick_up_time = service_time[deliveries[delivery].pickUp];
+        double drop_off_time = service_time[deliveries[delivery].dropOff];
+        constraints.deliveries[delivery].pick_up = {std::max(0.0, pick_up_time - slack(rng)), pick_up_time + slack(rng)};
+        constraints.deliveries[delivery].drop_off = {std::max(0.0, drop_off_time - slack(rng)), drop_off_time + slack(rng)};
+    }
+
+    constraints.truck_capacity = heaviest * spare_capacity(rng);
+    return constraints;
+}
+
+// Strongly connected component with the most intersections
+int largestComponent() {
+    std::unordered_map<int, int> component_size;
+    int largest = get_intersection_component(0);
+
+    for (IntersectionIdx intersection = 0; intersection < getNumIntersections(); intersection++) {
+        int component = get_intersection_component(intersection);
+        if (++component_size[component] > component_size[largest]) {
+            largest = component;
+        }
+    }
+    return largest;
+}
+
+}
+
+SUITE(truck_schedule) {
+    TEST(incremental_limits_match_full_replay) {
+        std::mt19937 rng(297);
+        std::vector<DeliveryInf> deliveries = pairedDeliveries();
+
+        std::vector<IntersectionIdx> depots;
+        for (int depot = 0; depot < NUM_DEPOTS; depot++) {
+            depots.push_back(FIRST_INTERSECTION + depot);
+        }
+
+        int kept_limits = 0;
+        int broke_limits = 0;
+
+        for (int instance = 0; instance < 10; instance++) {
+            CourierMatrix matrix = courier_test::randomCourierMatrix(NUM_DEPOTS + 2 * NUM_PAIRS + 1, rng);
+            DepotTable depot_table(matrix, depots);
+
+            std::vector<PickDrop> stops = randomLegalTour(deliveries, rng);
+            CourierConstraints constraints = constraintsAround(deliveries, stops, matrix, rng);
+            ScheduleLimits limits(deliveries, constraints);
+
+            AnnealingTour tour(stops, matrix, depot_table, limits);
+            CHECK(meetsConstraints(stops, matrix, limits));
+
+            for (int move_num = 0; move_num < NUM_MOVES; move_num++) {
+                TourMove move = courier_test::randomMove(static_cast<int>(stops.size()), rng);
+                if (!tour.isLegal(move)) {
+                    continue;
+                }
+
+                // Replay the whole tour the move would make
+                AnnealingTour moved = tour;
+                moved.apply(move);
+                bool meets_limits = meetsConstraints(moved.solution(moved.order), matrix, limits);
+
+                CHECK(tour.meetsLimits(move) == meets_limits);
+
+                // Walk on through tours that keep to the limits, so the profiles keep changing
+                if (meets_limits) {
+                    tour.apply(move);
+                    kept_limits++;
+                }
+                else {
+                    broke_limits++;
+                }
+            }
+        }
+
+        // Both answers came up often enough to mean something
+        CHECK(kept_limits > 1000);
+        CHECK(broke_limits > 1000);
+    } //incremental_limits_match_full_replay
+
+    TEST(constrained_route_passes_verifier) {
+        std::mt19937 rng(336);
+        std::uniform_int_distribution<IntersectionIdx> random_intersection(0, getNumIntersections() - 1);
+        int component = largestComponent();
+
+        auto componentIntersection = [&]() {
+            IntersectionIdx intersection = random_intersection(rng);
+            while (get_intersection_component(intersection) != component) {
+                intersection = random_intersection(rng);
+            }
+            return intersection;
+        };
+
+        std::vector<DeliveryInf> deliveries;
+        for (int delivery = 0; delivery < 12; delivery++) {
+            IntersectionIdx pick_up = componentIntersection();
+            deliveries.emplace_back(pick_up, componentIntersection());
+        }
+        std::vector<IntersectionIdx> depots = {componentIntersection(), componentIntersection(), componentIntersection()};
+
+        // Windows that only open late and never close, and room for a few items at a time, so a
+        // route always exists but the greedy order rarely is one
+        std::uniform_real_distribution<double> weight(1, 5);
+        std::uniform_real_distribution<double> opens(0, 600);
+
+        CourierOptions options;
+        options.time_budget = 5;
+        options.constraints.truck_capacity = 10;
+        options.constraints.deliveries.resize(deliveries.size());
+        for (DeliveryLimits& limits : options.constraints.deliveries) {
+            limits.item_weight = weight(rng);
+            limits.pick_up.open = opens(rng);
+            limits.drop_off.open = opens(rng);
+        }
+
+        std::vector<CourierSubPath> route = travelingCourier(15, deliveries, depots, options);
+
+        CHECK(!route.empty());
+        CHECK(ece297test::courier_path_is_legal(deliveries, depots, route));
+        CHECK(ece297test::courier_path_meets_constraints(deliveries, options.constraints, route, 15));
+    } //constrained_route_passes_verifier
+
+} //truck_schedule